@@ -4,26 +4,40 @@
 #include <iostream>
 #include <fstream>
 #include <sstream> 
+#include <string>
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
 
 
 struct AlgorithmConfig {
     int time_limit = 60;
     bool log_output = false;
+    std::string warm_start_solution;
+    bool renumber_locations = false;
+    bool stack_pickup_groups = false;
+    int decomposition_clusters = 0;
+    int decomposition_partitions = 4;
+    int route_cache_size = 1 << 16;
+    std::string constructor = "greedy";
+    int matching_candidates = 8;
+    int sparse_travel_time_neighbours = 0;
+    int route_pool_size = 0;
+    int route_pool_interval = 100;
+    int route_pool_node_limit = 100000;
+    int max_deliveries_per_courier = 4;
+    int max_delivery_time = 180;
+    // Courier IDs which may be used, all couriers if empty
+    std::vector<int> couriers;
+
+    AlgorithmConfig() {}
 
     AlgorithmConfig(const std::string& file_path) {
-        std::string line, key, value;
+        std::string line;
         std::ifstream ifs(file_path);
         if (ifs.is_open()) {
             while (ifs >> line) {
-                replace(line.begin(), line.end(), '=', ' ');
-                std::istringstream line_stream(line);
-                line_stream >> key >> value;
-                // std::cout << key << " " << value << std::endl;
-                if (key == "time_limit") {
-                    time_limit = std::stoi(value);
-                } else if (key == "log_output") {
-                    log_output = value == "true";
-                }
+                set_entry(line);
             }
             ifs.close();
         } else {
@@ -31,9 +45,69 @@ struct AlgorithmConfig {
         }
     }
 
+    // Applies a single "key=value" entry, returns false for unknown keys
+    bool set_entry(std::string line) {
+        std::string key, value;
+        replace(line.begin(), line.end(), '=', ' ');
+        std::istringstream line_stream(line);
+        line_stream >> key >> value;
+        // std::cout << key << " " << value << std::endl;
+        if (key == "time_limit") {
+            time_limit = std::stoi(value);
+        } else if (key == "log_output") {
+            log_output = value == "true";
+        } else if (key == "warm_start_solution") {
+            warm_start_solution = value;
+        } else if (key == "renumber_locations") {
+            renumber_locations = value == "true";
+        } else if (key == "stack_pickup_groups") {
+            stack_pickup_groups = value == "true";
+        } else if (key == "decomposition_clusters") {
+            decomposition_clusters = std::stoi(value);
+        } else if (key == "decomposition_partitions") {
+            decomposition_partitions = std::stoi(value);
+        } else if (key == "route_cache_size") {
+            route_cache_size = std::stoi(value);
+        } else if (key == "constructor") {
+            constructor = value;
+        } else if (key == "matching_candidates") {
+            matching_candidates = std::stoi(value);
+        } else if (key == "sparse_travel_time_neighbours") {
+            sparse_travel_time_neighbours = std::stoi(value);
+        } else if (key == "route_pool_size") {
+            route_pool_size = std::stoi(value);
+        } else if (key == "route_pool_interval") {
+            route_pool_interval = std::stoi(value);
+        } else if (key == "route_pool_node_limit") {
+            route_pool_node_limit = std::stoi(value);
+        } else if (key == "max_deliveries_per_courier") {
+            max_deliveries_per_courier = std::stoi(value);
+            // Routes are stacked exhaustively and cached with up to four deliveries
+            if (max_deliveries_per_courier < 1 || max_deliveries_per_courier > 4) {
+                throw std::runtime_error("max_deliveries_per_courier must be between 1 and 4");
+            }
+        } else if (key == "max_delivery_time") {
+            max_delivery_time = std::stoi(value);
+        } else if (key == "couriers") {
+            // Comma separated courier IDs and ID ranges, e.g. 1-20,25
+            couriers.clear();
+            std::istringstream value_stream(value);
+            std::string item;
+            while (std::getline(value_stream, item, ',')) {
+                size_t dash = item.find('-');
+                int first_id = std::stoi(item.substr(0, dash));
+                int last_id = dash == std::string::npos ? first_id : std::stoi(item.substr(dash + 1));
+                for (int courier_id = first_id; courier_id <= last_id; ++courier_id) couriers.push_back(courier_id);
+            }
+        } else {
+            return false;
+        }
+        return true;
+    }
+
 };
 
 
 
 
-#endif // ALGORITHM_CONFIG_CPP
\ No newline at end of file
+#endif // ALGORITHM_CONFIG_CPP
@@ -0,0 +1,92 @@
+#ifndef APPEND_COST_KERNEL_CPP
+#define APPEND_COST_KERNEL_CPP
+
+#include <vector>
+#include <algorithm>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#include "vrppd_parameters.h"
+
+// Courier/candidate pairs of one greedy round as structure of arrays. The kernel fills delivery_time with
+// max(current_time + travel(from, pickup), release_time) + travel(pickup, dropoff) and is_within_time_limit
+// with the time limit check of the greedy heuristic.
+struct AppendCostBatch {
+    std::vector<int> courier_index;
+    std::vector<int> delivery_index;
+    std::vector<int> from_location;
+    std::vector<int> pickup_location;
+    std::vector<double> current_time;
+    std::vector<double> release_time;
+    std::vector<double> direct_travel_time;
+    std::vector<double> delivery_time;
+    std::vector<unsigned char> is_within_time_limit;
+
+    size_t size() const { return courier_index.size(); }
+
+    void clear() {
+        courier_index.clear();
+        delivery_index.clear();
+        from_location.clear();
+        pickup_location.clear();
+        current_time.clear();
+        release_time.clear();
+        direct_travel_time.clear();
+    }
+
+    void push_back(const VRPPDParameters& param, int courier, int location, double time, int delivery) {
+        courier_index.push_back(courier);
+        delivery_index.push_back(delivery);
+        from_location.push_back(location);
+        pickup_location.push_back(param.delivery_pickup_location[delivery - 1]);
+        current_time.push_back(time);
+        release_time.push_back(param.delivery_release_time[delivery - 1]);
+        direct_travel_time.push_back(param.delivery_direct_travel_time[delivery - 1]);
+    }
+};
+
+void compute_append_delivery_times(const VRPPDParameters& param, AppendCostBatch& batch, double max_delivery_time) {
+    size_t pair_count = batch.size();
+    batch.delivery_time.resize(pair_count);
+    batch.is_within_time_limit.resize(pair_count);
+    const TravelTimeMatrix& travel_time = param.location_distance_matrix;
+    const double* dense_travel_times = travel_time.dense_data();
+    size_t i = 0;
+
+    if (dense_travel_times != nullptr) {
+        long long location_count = travel_time.size();
+#if defined(__AVX2__)
+        __m256d time_limit = _mm256_set1_pd(max_delivery_time);
+        __m256i row_length = _mm256_set1_epi64x(location_count);
+        for (; i + 4 <= pair_count; i += 4) {
+            __m256i from = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.from_location[i])));
+            __m256i pickup = _mm256_cvtepi32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&batch.pickup_location[i])));
+            // Location indices fit into 32 bits, the products are full 64 bit offsets
+            __m256i offset = _mm256_add_epi64(_mm256_mul_epu32(from, row_length), pickup);
+            __m256d travel = _mm256_i64gather_pd(dense_travel_times, offset, 8);
+            __m256d current_time = _mm256_loadu_pd(&batch.current_time[i]);
+            __m256d delivery_time = _mm256_add_pd(
+                _mm256_max_pd(_mm256_add_pd(current_time, travel), _mm256_loadu_pd(&batch.release_time[i])),
+                _mm256_loadu_pd(&batch.direct_travel_time[i]));
+            _mm256_storeu_pd(&batch.delivery_time[i], delivery_time);
+            int within_mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_add_pd(current_time, delivery_time), time_limit, _CMP_LE_OQ));
+            for (int lane = 0; lane < 4; ++lane) batch.is_within_time_limit[i + lane] = (within_mask >> lane) & 1;
+        }
+#endif
+        for (; i < pair_count; ++i) {
+            double travel = dense_travel_times[batch.from_location[i] * location_count + batch.pickup_location[i]];
+            batch.delivery_time[i] = std::max(batch.current_time[i] + travel, batch.release_time[i]) + batch.direct_travel_time[i];
+            batch.is_within_time_limit[i] = batch.current_time[i] + batch.delivery_time[i] <= max_delivery_time;
+        }
+        return;
+    }
+
+    // In sparse travel time mode every lookup is a search in the row of the location
+    for (; i < pair_count; ++i) {
+        double travel = travel_time(batch.from_location[i], batch.pickup_location[i]);
+        batch.delivery_time[i] = std::max(batch.current_time[i] + travel, batch.release_time[i]) + batch.direct_travel_time[i];
+        batch.is_within_time_limit[i] = batch.current_time[i] + batch.delivery_time[i] <= max_delivery_time;
+    }
+}
+
+#endif // APPEND_COST_KERNEL_CPP
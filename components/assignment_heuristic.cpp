@@ -0,0 +1,154 @@
+#ifndef ASSIGNMENT_HEURISTIC_CPP
+#define ASSIGNMENT_HEURISTIC_CPP
+
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+#include "vrppd_parameters.h"
+#include "vrppd_solution.h"
+#include "algorithm_config.h"
+#include "heuristic_generator.cpp"
+
+struct AssignmentEdge {
+    int column;
+    double cost;
+};
+
+// Minimum cost assignment of rows to columns on a sparse set of edges by successive shortest augmenting
+// paths (Dijkstra on reduced costs). Every search starts from all unmatched rows at once, so each augmentation
+// adds the cheapest path of any row and the result has maximum cardinality and, among those assignments,
+// minimum total cost. Returns the matched column of each row, or -1.
+std::vector<int> sparse_min_cost_assignment(const std::vector<std::vector<AssignmentEdge> >& row_edges, int column_count) {
+    int row_count = row_edges.size();
+    const double infinity = std::numeric_limits<double>::infinity();
+    std::vector<int> row_match(row_count, -1), column_match(column_count, -1);
+    std::vector<double> distance(column_count, infinity);
+    std::vector<int> predecessor_row(column_count, -1);
+    std::vector<bool> is_done(column_count, false);
+    std::vector<int> touched_columns, done_columns;
+
+    // Unmatched rows share one potential, so the reduced path lengths of different start rows are comparable.
+    // Starting at the cheapest edge keeps all reduced costs cost - row_potential - column_potential non-negative.
+    double minimum_cost = infinity;
+    for (const auto& edges : row_edges) {
+        for (const auto& edge : edges) minimum_cost = std::min(minimum_cost, edge.cost);
+    }
+    std::vector<double> row_potential(row_count, minimum_cost == infinity ? 0 : minimum_cost), column_potential(column_count, 0);
+
+    typedef std::pair<double, int> QueueEntry;
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > queue;
+    auto relax = [&](int row, double row_distance) {
+        for (const auto& edge : row_edges[row]) {
+            double new_distance = row_distance + edge.cost - row_potential[row] - column_potential[edge.column];
+            if (!is_done[edge.column] && new_distance < distance[edge.column]) {
+                if (distance[edge.column] == infinity) touched_columns.push_back(edge.column);
+                distance[edge.column] = new_distance;
+                predecessor_row[edge.column] = row;
+                queue.push({new_distance, edge.column});
+            }
+        }
+    };
+
+    while (true) {
+        for (int row = 0; row < row_count; ++row) {
+            if (row_match[row] < 0) relax(row, 0);
+        }
+
+        int sink_column = -1;
+        while (!queue.empty()) {
+            auto [column_distance, column] = queue.top();
+            queue.pop();
+            if (is_done[column] || column_distance > distance[column]) continue;
+            is_done[column] = true;
+            done_columns.push_back(column);
+            if (column_match[column] < 0) {
+                sink_column = column;
+                break;
+            }
+            relax(column_match[column], column_distance);
+        }
+        queue = decltype(queue)();
+
+        if (sink_column >= 0) {
+            double sink_distance = distance[sink_column];
+            for (int column : done_columns) {
+                double shift = sink_distance - distance[column];
+                column_potential[column] -= shift;
+                if (column_match[column] >= 0) row_potential[column_match[column]] += shift;
+            }
+            for (int row = 0; row < row_count; ++row) {
+                if (row_match[row] < 0) row_potential[row] += sink_distance;
+            }
+
+            int column = sink_column;
+            while (column >= 0) {
+                int row = predecessor_row[column];
+                int next_column = row_match[row];
+                row_match[row] = column;
+                column_match[column] = row;
+                column = next_column;
+            }
+        }
+
+        for (int column : touched_columns) {
+            distance[column] = infinity;
+            is_done[column] = false;
+            predecessor_row[column] = -1;
+        }
+        touched_columns.clear();
+        done_columns.clear();
+        if (sink_column < 0) break;
+    }
+    return row_match;
+}
+
+// Builds a solution layer by layer: in every layer each courier gets at most one further delivery, chosen by a
+// minimum cost assignment over the matching_candidates nearest feasible deliveries of each courier, with the
+// delivery time of appending the delivery as cost. Deliveries left after the last layer are assigned by the
+// random greedy heuristic. The routes are stacked afterwards by the caller.
+void matching_courier_heuristic(const VRPPDParameters& param, VRPPDSolution& sol, const AlgorithmConfig& algorithm_config) {
+    sol.total_delivery_time = 0;
+    std::vector<CourierState> courier_states;
+    for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+        courier_states.emplace_back(courier_index, param.courier_starting_location[courier_index - 1], 0);
+    }
+
+    int assigned_deliveries = 0;
+    for (int layer = 0; layer < sol.max_num_of_deliveries_assignable_to_courier && assigned_deliveries < param.delivery_count; ++layer) {
+        std::vector<std::vector<AssignmentEdge> > courier_edges(param.courier_count);
+        for (const auto& courier_state : courier_states) {
+            int courier_index = courier_state.courier_index;
+            if (sol.delivery_count_assigned_to_courier[courier_index - 1] >= sol.max_num_of_deliveries_assignable_to_courier ||
+                !sol.courier_is_available[courier_index - 1]) continue;
+            for (int delivery_index : param.location_nearest_delivery_matrix[courier_state.current_location]) {
+                if (static_cast<int>(courier_edges[courier_index - 1].size()) >= algorithm_config.matching_candidates) break;
+                if (sol.delivery_assigned_courier[delivery_index - 1] != 0 ||
+                    param.delivery_capacity[delivery_index - 1] > param.courier_capacity[courier_index - 1]) continue;
+                double delivery_time = append_delivery_delivery_time(param, sol, courier_state, delivery_index);
+                if (courier_state.current_time + delivery_time > sol.max_delivery_delivery_time) continue;
+                courier_edges[courier_index - 1].push_back({delivery_index - 1, delivery_time});
+            }
+        }
+
+        std::vector<int> courier_match = sparse_min_cost_assignment(courier_edges, param.delivery_count);
+        int layer_assigned_deliveries = 0;
+        for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+            if (courier_match[courier_index - 1] < 0) continue;
+            int delivery_index = courier_match[courier_index - 1] + 1;
+            apply_courier_move(param, sol, courier_states[courier_index - 1],
+                CourierMove(courier_index, delivery_index, append_delivery_delivery_time(param, sol, courier_states[courier_index - 1], delivery_index), true));
+            layer_assigned_deliveries++;
+        }
+        assigned_deliveries += layer_assigned_deliveries;
+        if (layer_assigned_deliveries == 0) break;
+    }
+
+    if (assigned_deliveries < param.delivery_count) {
+        random_greedy_courier_heuristic(param, sol, algorithm_config);
+    } else {
+        sol.is_feasible_solution = true;
+    }
+}
+
+#endif // ASSIGNMENT_HEURISTIC_CPP
@@ -0,0 +1,273 @@
+#ifndef DECOMPOSITION_CPP
+#define DECOMPOSITION_CPP
+
+#include <vector>
+#include <random>
+#include <thread>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <limits>
+#include "vrppd_parameters.h"
+#include "vrppd_solution.h"
+#include "algorithm_config.h"
+#include "heuristic_generator.cpp"
+#include "worker_pool.h"
+
+// View on a part of an instance, the indices refer to the couriers and deliveries of the full VRPPDParameters
+struct VRPPDSubproblem {
+    std::vector<int> courier_indices;
+    std::vector<int> delivery_indices;
+};
+
+// Spatial-temporal distance of two deliveries: travel time between the pickups plus the gap of the release times
+double delivery_distance(const VRPPDParameters& param, int delivery_a, int delivery_b) {
+    return param.location_distance_matrix(param.delivery_pickup_location[delivery_a - 1], param.delivery_pickup_location[delivery_b - 1])
+        + std::abs(param.delivery_release_time[delivery_a - 1] - param.delivery_release_time[delivery_b - 1]);
+}
+
+// Partitions the deliveries around cluster_count far apart center deliveries (farthest point sampling from a
+// random start) and assigns every available courier to the closest cluster which still needs couriers. The
+// number of couriers of a cluster is proportional to its number of deliveries.
+std::vector<VRPPDSubproblem> partition_instance(const VRPPDParameters& param, int cluster_count, const std::vector<bool>& courier_is_available, std::mt19937& gen) {
+    int available_courier_count = std::count(courier_is_available.begin(), courier_is_available.end(), true);
+    cluster_count = std::max(1, std::min({cluster_count, param.delivery_count, available_courier_count}));
+    std::vector<VRPPDSubproblem> subproblems(cluster_count);
+
+    std::vector<int> center_deliveries;
+    std::vector<double> distance_to_centers(param.delivery_count, std::numeric_limits<double>::max());
+    std::vector<int> delivery_cluster(param.delivery_count, 0);
+    std::uniform_int_distribution<> first_center(1, param.delivery_count);
+    int next_center = first_center(gen);
+    while (static_cast<int>(center_deliveries.size()) < cluster_count) {
+        int cluster = center_deliveries.size();
+        center_deliveries.push_back(next_center);
+        next_center = 1;
+        for (int delivery_index = 1; delivery_index <= param.delivery_count; ++delivery_index) {
+            double distance = delivery_distance(param, center_deliveries[cluster], delivery_index);
+            if (distance < distance_to_centers[delivery_index - 1]) {
+                distance_to_centers[delivery_index - 1] = distance;
+                delivery_cluster[delivery_index - 1] = cluster;
+            }
+            if (distance_to_centers[delivery_index - 1] > distance_to_centers[next_center - 1]) next_center = delivery_index;
+        }
+    }
+    for (int delivery_index = 1; delivery_index <= param.delivery_count; ++delivery_index) {
+        subproblems[delivery_cluster[delivery_index - 1]].delivery_indices.push_back(delivery_index);
+    }
+
+    std::vector<int> courier_quota(cluster_count);
+    for (int cluster = 0; cluster < cluster_count; ++cluster) {
+        courier_quota[cluster] = static_cast<int>(std::ceil(static_cast<double>(available_courier_count) * subproblems[cluster].delivery_indices.size() / param.delivery_count));
+    }
+    std::vector<std::pair<double, std::pair<int, int> > > courier_cluster_distances;
+    courier_cluster_distances.reserve(static_cast<size_t>(param.courier_count) * cluster_count);
+    for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+        if (!courier_is_available[courier_index - 1]) continue;
+        for (int cluster = 0; cluster < cluster_count; ++cluster) {
+            double distance = param.location_distance_matrix(param.courier_starting_location[courier_index - 1], param.delivery_pickup_location[center_deliveries[cluster] - 1]);
+            courier_cluster_distances.push_back({distance, {courier_index, cluster}});
+        }
+    }
+    std::sort(courier_cluster_distances.begin(), courier_cluster_distances.end());
+    std::vector<bool> is_courier_assigned(param.courier_count, false);
+    for (const auto& entry : courier_cluster_distances) {
+        int courier_index = entry.second.first, cluster = entry.second.second;
+        if (is_courier_assigned[courier_index - 1] || courier_quota[cluster] == 0) continue;
+        is_courier_assigned[courier_index - 1] = true;
+        courier_quota[cluster]--;
+        subproblems[cluster].courier_indices.push_back(courier_index);
+    }
+
+    return subproblems;
+}
+
+// Appends the deliveries which could not be served within their cluster across the cluster boundaries, each to
+// the courier of any cluster which delivers it earliest after its current route. Only these deliveries and the
+// couriers with free slots take part. Marks the solution infeasible if a delivery fits no courier.
+void repair_unserved_deliveries(const VRPPDParameters& param, VRPPDSolution& sol) {
+    std::vector<int> unserved_deliveries;
+    for (int delivery_index = 1; delivery_index <= param.delivery_count; ++delivery_index) {
+        if (sol.delivery_assigned_courier[delivery_index - 1] == 0) unserved_deliveries.push_back(delivery_index);
+    }
+    std::sort(unserved_deliveries.begin(), unserved_deliveries.end(),
+        [&](int a, int b) { return param.delivery_release_time[a - 1] < param.delivery_release_time[b - 1]; });
+
+    std::vector<CourierState> courier_states;
+    for (int courier_index = 1; courier_index <= param.courier_count && !unserved_deliveries.empty(); ++courier_index) {
+        if (sol.courier_is_available[courier_index - 1] &&
+            sol.delivery_count_assigned_to_courier[courier_index - 1] < sol.max_num_of_deliveries_assignable_to_courier) {
+            courier_states.push_back(courier_state_of_solution(param, sol, courier_index));
+        }
+    }
+
+    for (int delivery_index : unserved_deliveries) {
+        CourierState* best_courier_state = nullptr;
+        double best_delivery_time = std::numeric_limits<double>::infinity();
+        for (auto& courier_state : courier_states) {
+            int courier_index = courier_state.courier_index;
+            if (sol.delivery_count_assigned_to_courier[courier_index - 1] >= sol.max_num_of_deliveries_assignable_to_courier ||
+                param.delivery_capacity[delivery_index - 1] > param.courier_capacity[courier_index - 1]) continue;
+            double delivery_time = append_delivery_delivery_time(param, sol, courier_state, delivery_index);
+            if (courier_state.current_time + delivery_time <= sol.max_delivery_delivery_time && delivery_time < best_delivery_time) {
+                best_courier_state = &courier_state;
+                best_delivery_time = delivery_time;
+            }
+        }
+        if (best_courier_state == nullptr) {
+            sol.total_delivery_time = std::numeric_limits<double>::max();
+            sol.is_feasible_solution = false;
+            return;
+        }
+        apply_courier_move(param, sol, *best_courier_state, CourierMove(best_courier_state->courier_index, delivery_index, best_delivery_time, true));
+    }
+    sol.is_feasible_solution = true;
+}
+
+// Relocates deliveries across the cluster boundaries: the last delivery of a route moves to the end of the route
+// of a courier of another cluster if it is delivered earlier there. The deliveries before it keep their times, so
+// every move decreases the total delivery time. Only the couriers whose routes end at the pickup location or at
+// one of its nearest_location_count nearest locations are tried. courier_cluster is -1 for couriers outside all
+// clusters.
+void relocate_boundary_deliveries(const VRPPDParameters& param, VRPPDSolution& sol, const std::vector<int>& courier_cluster, int nearest_location_count = 16) {
+    std::vector<CourierState> courier_states;
+    // Couriers by the location their route ends at, entries of couriers which moved on are skipped when read
+    std::vector<std::vector<int> > location_couriers(param.location_count);
+    for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+        courier_states.push_back(courier_state_of_solution(param, sol, courier_index));
+        if (courier_cluster[courier_index - 1] >= 0) location_couriers[courier_states.back().current_location].push_back(courier_index);
+    }
+    std::vector<int> courier_tried_delivery(param.courier_count, 0);
+
+    for (int source_courier = 1; source_courier <= param.courier_count; ++source_courier) {
+        if (courier_cluster[source_courier - 1] < 0) continue;
+        std::vector<int>& source_route = sol.routing_plan[source_courier - 1];
+        int& source_delivery_count = sol.delivery_count_assigned_to_courier[source_courier - 1];
+        // Only a delivery picked up right before its dropoff leaves the route without changing the other stops
+        while (source_delivery_count > 0 && source_route[2 * source_delivery_count - 2] == -source_route[2 * source_delivery_count - 1]) {
+            int delivery_index = source_route[2 * source_delivery_count - 2];
+            int pickup_location = param.delivery_pickup_location[delivery_index - 1];
+            int best_courier = 0;
+            double best_delivery_time = sol.delivery_delivery_time[delivery_index - 1] - 1e-6;
+            // A delivery picked up at its release time cannot be delivered earlier
+            if (best_delivery_time <= param.delivery_release_time[delivery_index - 1] + param.delivery_direct_travel_time[delivery_index - 1]) break;
+
+            const std::vector<int>& nearest_locations = param.location_nearest_location_matrix[pickup_location];
+            int searched_location_count = std::min<int>(nearest_location_count, nearest_locations.size());
+            for (int rank = -1; rank < searched_location_count; ++rank) {
+                int location = rank < 0 ? pickup_location : nearest_locations[rank];
+                for (int target_courier : location_couriers[location]) {
+                    const CourierState& target_state = courier_states[target_courier - 1];
+                    if (target_state.current_location != location || courier_tried_delivery[target_courier - 1] == delivery_index ||
+                        courier_cluster[target_courier - 1] == courier_cluster[source_courier - 1] ||
+                        sol.delivery_count_assigned_to_courier[target_courier - 1] >= sol.max_num_of_deliveries_assignable_to_courier ||
+                        param.delivery_capacity[delivery_index - 1] > param.courier_capacity[target_courier - 1]) continue;
+                    courier_tried_delivery[target_courier - 1] = delivery_index;
+                    double delivery_time = append_delivery_delivery_time(param, sol, target_state, delivery_index);
+                    if (target_state.current_time + delivery_time <= sol.max_delivery_delivery_time && delivery_time < best_delivery_time) {
+                        best_courier = target_courier;
+                        best_delivery_time = delivery_time;
+                    }
+                }
+            }
+            if (best_courier == 0) break;
+
+            double delivery_time = sol.delivery_delivery_time[delivery_index - 1];
+            source_route[2 * source_delivery_count - 2] = 0;
+            source_route[2 * source_delivery_count - 1] = 0;
+            source_delivery_count--;
+            sol.courier_attributed_delivery_time[source_courier - 1] -= delivery_time;
+            sol.total_delivery_time -= delivery_time;
+            sol.courier_route_is_stacked[source_courier - 1] = false;
+            courier_states[source_courier - 1] = courier_state_of_solution(param, sol, source_courier);
+            location_couriers[courier_states[source_courier - 1].current_location].push_back(source_courier);
+            apply_courier_move(param, sol, courier_states[best_courier - 1], CourierMove(best_courier, delivery_index, best_delivery_time, true));
+            location_couriers[courier_states[best_courier - 1].current_location].push_back(best_courier);
+        }
+    }
+}
+
+// Clusters of one partition with their sub-instances
+struct VRPPDPartition {
+    std::vector<VRPPDSubproblem> subproblems;
+    std::vector<VRPPDParameters> subproblem_params;
+    // Cluster of every courier, -1 for the couriers which are not available
+    std::vector<int> courier_cluster;
+};
+
+// Decomposed construction: every restart solves the clusters of a partition concurrently on their compact
+// sub-instances, repairs the deliveries left unserved at the cluster boundaries and relocates deliveries across
+// them. Up to
+// decomposition_partitions partitions are built from different random centers and reused round robin by later
+// restarts, so the sub-instances are not rebuilt in every restart.
+class DecomposedGreedyHeuristic {
+private:
+    const VRPPDParameters& param;
+    const AlgorithmConfig& algorithm_config;
+    std::vector<bool> courier_is_available;
+    std::vector<VRPPDPartition> partitions;
+    size_t restart_count = 0;
+    WorkerPool worker_pool;
+
+public:
+    DecomposedGreedyHeuristic(const VRPPDParameters& param, const AlgorithmConfig& algorithm_config, const VRPPDSolution& empty_solution)
+        : param(param), algorithm_config(algorithm_config), courier_is_available(empty_solution.courier_is_available),
+          worker_pool(std::min<size_t>(algorithm_config.decomposition_clusters, std::max(1u, std::thread::hardware_concurrency()))) {}
+
+    // Builds a solution from the empty solution sol
+    void construct(VRPPDSolution& sol, std::mt19937& gen) {
+        if (partitions.size() < static_cast<size_t>(std::max(1, algorithm_config.decomposition_partitions))) {
+            VRPPDPartition partition;
+            partition.subproblems = partition_instance(param, algorithm_config.decomposition_clusters, courier_is_available, gen);
+            partition.courier_cluster.assign(param.courier_count, -1);
+            for (size_t cluster = 0; cluster < partition.subproblems.size(); ++cluster) {
+                const VRPPDSubproblem& subproblem = partition.subproblems[cluster];
+                partition.subproblem_params.emplace_back(param, subproblem.courier_indices, subproblem.delivery_indices);
+                for (int courier_index : subproblem.courier_indices) partition.courier_cluster[courier_index - 1] = cluster;
+            }
+            partitions.push_back(std::move(partition));
+        }
+        const VRPPDPartition& partition = partitions[restart_count++ % partitions.size()];
+
+        std::vector<VRPPDSolution> subproblem_solutions;
+        for (const auto& subproblem_param : partition.subproblem_params) {
+            subproblem_solutions.emplace_back(subproblem_param.courier_count, subproblem_param.delivery_count,
+                sol.max_num_of_deliveries_assignable_to_courier, sol.max_delivery_delivery_time);
+        }
+        worker_pool.run(partition.subproblems.size(), [&](size_t cluster) {
+            random_greedy_courier_heuristic(partition.subproblem_params[cluster], subproblem_solutions[cluster], algorithm_config);
+        });
+
+        // A cluster which could not serve all its deliveries keeps the routes it built
+        for (size_t cluster = 0; cluster < partition.subproblems.size(); ++cluster) {
+            const VRPPDSubproblem& subproblem = partition.subproblems[cluster];
+            const VRPPDSolution& subproblem_solution = subproblem_solutions[cluster];
+            for (size_t local_courier = 0; local_courier < subproblem.courier_indices.size(); ++local_courier) {
+                int courier_index = subproblem.courier_indices[local_courier];
+                for (size_t stop = 0; stop < subproblem_solution.routing_plan[local_courier].size(); ++stop) {
+                    int local_stop = subproblem_solution.routing_plan[local_courier][stop];
+                    sol.routing_plan[courier_index - 1][stop] = local_stop > 0 ? subproblem.delivery_indices[local_stop - 1]
+                        : local_stop < 0 ? -subproblem.delivery_indices[-local_stop - 1] : 0;
+                }
+                sol.delivery_count_assigned_to_courier[courier_index - 1] = subproblem_solution.delivery_count_assigned_to_courier[local_courier];
+                sol.courier_attributed_delivery_time[courier_index - 1] = subproblem_solution.courier_attributed_delivery_time[local_courier];
+                sol.courier_route_is_stacked[courier_index - 1] = subproblem_solution.courier_route_is_stacked[local_courier];
+            }
+            for (size_t local_delivery = 0; local_delivery < subproblem.delivery_indices.size(); ++local_delivery) {
+                int delivery_index = subproblem.delivery_indices[local_delivery];
+                int local_courier = subproblem_solution.delivery_assigned_courier[local_delivery];
+                sol.delivery_assigned_courier[delivery_index - 1] = local_courier > 0 ? subproblem.courier_indices[local_courier - 1] : 0;
+                sol.delivery_delivery_time[delivery_index - 1] = subproblem_solution.delivery_delivery_time[local_delivery];
+            }
+        }
+        sol.total_delivery_time = 0;
+        for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+            sol.total_delivery_time += sol.courier_attributed_delivery_time[courier_index - 1];
+        }
+
+        repair_unserved_deliveries(param, sol);
+        if (sol.is_feasible_solution) relocate_boundary_deliveries(param, sol, partition.courier_cluster);
+    }
+};
+
+#endif // DECOMPOSITION_CPP
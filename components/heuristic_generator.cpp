@@ -3,9 +3,12 @@
 
 #include "vrppd_solution.h"
 #include "vrppd_parameters.h"
+#include "algorithm_config.h"
+#include "append_cost_kernel.cpp"
 #include <random>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 
 struct CourierState {
     int courier_index;
@@ -30,9 +33,9 @@ double append_delivery_delivery_time(const VRPPDParameters& param, const VRPPDSo
     int delivery_pickup_location = param.delivery_pickup_location[delivery_index - 1];
     int delivery_dropoff_location = param.delivery_dropoff_location[delivery_index - 1];
     double delivery_time = std::max(
-        courier_state.current_time + param.location_distance_matrix[courier_state.current_location][delivery_pickup_location],
+        courier_state.current_time + param.location_distance_matrix(courier_state.current_location, delivery_pickup_location),
         param.delivery_release_time[delivery_index - 1]
-    ) + param.location_distance_matrix[delivery_pickup_location][delivery_dropoff_location];
+    ) + param.location_distance_matrix(delivery_pickup_location, delivery_dropoff_location);
     return delivery_time;
 }
 
@@ -49,37 +52,126 @@ void apply_courier_move(const VRPPDParameters& param, VRPPDSolution& sol, Courie
         sol.delivery_count_assigned_to_courier[courier_move.courier_index - 1]++;
         sol.delivery_delivery_time[courier_move.delivery_index - 1] = delivery_delivery_time;
         sol.courier_attributed_delivery_time[courier_move.courier_index - 1] += delivery_delivery_time;
+        sol.courier_route_is_stacked[courier_move.courier_index - 1] = false;
     } else {
         throw std::runtime_error("Non-appending moves not implemented");
     }
 }
 
+// Extends the move of a courier to the unassigned deliveries of the same stacking group which are released
+// before the courier reaches the pickup. All deliveries of the bundle are picked up together and dropped off
+// in the returned order, a delivery is skipped if it breaks the capacity or the time limit, or if its dropoff
+// is closer to the pickup than to the previous dropoff of the bundle.
+std::vector<int> pickup_group_bundle(const VRPPDParameters& param, const VRPPDSolution& sol, const CourierState& courier_state, const CourierMove& courier_move) {
+    int anchor_delivery = courier_move.delivery_index;
+    int pickup_location = param.delivery_pickup_location[anchor_delivery - 1];
+    int last_dropoff_location = param.delivery_dropoff_location[anchor_delivery - 1];
+    double pickup_time = std::max(
+        courier_state.current_time + param.location_distance_matrix(courier_state.current_location, pickup_location),
+        param.delivery_release_time[anchor_delivery - 1]
+    );
+    double dropoff_time = pickup_time + param.location_distance_matrix(pickup_location, last_dropoff_location);
+    double load = param.delivery_capacity[anchor_delivery - 1];
+    int free_slots = sol.max_num_of_deliveries_assignable_to_courier - sol.delivery_count_assigned_to_courier[courier_state.courier_index - 1];
+
+    std::vector<int> bundle = {anchor_delivery};
+    for (int delivery_index : param.stacking_group_deliveries[param.delivery_stacking_group[anchor_delivery - 1]]) {
+        if (static_cast<int>(bundle.size()) >= free_slots) break;
+        if (param.delivery_release_time[delivery_index - 1] > pickup_time) break;
+        if (delivery_index == anchor_delivery || sol.delivery_assigned_courier[delivery_index - 1] != 0) continue;
+        if (load + param.delivery_capacity[delivery_index - 1] > param.courier_capacity[courier_state.courier_index - 1]) continue;
+
+        int dropoff_location = param.delivery_dropoff_location[delivery_index - 1];
+        if (param.location_distance_matrix(last_dropoff_location, dropoff_location) > param.location_distance_matrix(pickup_location, dropoff_location)) continue;
+        double delivery_time = dropoff_time + param.location_distance_matrix(last_dropoff_location, dropoff_location);
+        if (delivery_time > sol.max_delivery_delivery_time) continue;
+
+        bundle.push_back(delivery_index);
+        load += param.delivery_capacity[delivery_index - 1];
+        last_dropoff_location = dropoff_location;
+        dropoff_time = delivery_time;
+    }
+    return bundle;
+}
+
+void apply_courier_bundle_move(const VRPPDParameters& param, VRPPDSolution& sol, CourierState& courier_state, const std::vector<int>& bundle) {
+    int courier_index = courier_state.courier_index;
+    int route_position = 2 * sol.delivery_count_assigned_to_courier[courier_index - 1];
+    int pickup_location = param.delivery_pickup_location[bundle[0] - 1];
+    double current_time = courier_state.current_time + param.location_distance_matrix(courier_state.current_location, pickup_location);
+    int current_location = pickup_location;
+
+    for (int delivery_index : bundle) {
+        current_time = std::max(current_time, param.delivery_release_time[delivery_index - 1]);
+        sol.routing_plan[courier_index - 1][route_position++] = delivery_index;
+        sol.delivery_assigned_courier[delivery_index - 1] = courier_index;
+    }
+    for (int delivery_index : bundle) {
+        int delivery_dropoff_location = param.delivery_dropoff_location[delivery_index - 1];
+        current_time += param.location_distance_matrix(current_location, delivery_dropoff_location);
+        current_location = delivery_dropoff_location;
+        sol.routing_plan[courier_index - 1][route_position++] = -delivery_index;
+        sol.delivery_delivery_time[delivery_index - 1] = current_time;
+        sol.courier_attributed_delivery_time[courier_index - 1] += current_time;
+        sol.total_delivery_time += current_time;
+    }
+    sol.delivery_count_assigned_to_courier[courier_index - 1] += bundle.size();
+    sol.courier_route_is_stacked[courier_index - 1] = false;
+    courier_state.current_location = current_location;
+    courier_state.current_time = current_time;
+}
+
+// Finds the nearest unassigned delivery of a courier. Every location keeps a bitset over the ranks of its
+// nearest delivery list, a bit is cleared once the delivery is seen assigned. Intersected with the capacity
+// mask of the courier's capacity class, a scan skips assigned and too large deliveries a word at a time.
+// Capacity and time limit are never written back, so couriers sharing a location do not cut each other off.
 class GreedyDeliveryFinder {
 private:
-    std::vector<int> count_of_already_considered_closest_deliveries_from_location;
+    std::vector<uint64_t> location_unassigned_delivery_bits;
+    // First word of every location which may still hold a set bit
+    std::vector<size_t> location_first_unassigned_word;
 
 public:
     GreedyDeliveryFinder(const VRPPDParameters& param)
-        : count_of_already_considered_closest_deliveries_from_location(param.location_count, 0) {}
+        : location_unassigned_delivery_bits(param.location_delivery_bits),
+          location_first_unassigned_word(param.location_delivery_bits_offset.begin(), param.location_delivery_bits_offset.end() - 1) {}
 
-    CourierMove greedy_delivery_of_courier(const VRPPDParameters& param, const VRPPDSolution& sol, const CourierState& courier_state) {
+    // Nearest unassigned delivery which fits into the courier, 0 if there is none
+    int nearest_candidate_delivery(const VRPPDParameters& param, const VRPPDSolution& sol, const CourierState& courier_state) {
+        if (sol.delivery_count_assigned_to_courier[courier_state.courier_index - 1] >= sol.max_num_of_deliveries_assignable_to_courier ||
+            !sol.courier_is_available[courier_state.courier_index - 1]) {
+            return 0;
+        }
         int current_location = courier_state.current_location;
-        for (int i = count_of_already_considered_closest_deliveries_from_location[current_location]; i < param.delivery_count; ++i) {
-            int closest_delivery = param.location_nearest_delivery_matrix[current_location][i];
-            if(
-                sol.delivery_count_assigned_to_courier[courier_state.courier_index - 1] >= sol.max_num_of_deliveries_assignable_to_courier
-            ){
-                count_of_already_considered_closest_deliveries_from_location[current_location] = param.delivery_count;
-                break;
-            } else if (sol.delivery_assigned_courier[closest_delivery - 1] > 0 || 
-                param.delivery_capacity[closest_delivery - 1] > param.courier_capacity[courier_state.courier_index - 1]) {
-                count_of_already_considered_closest_deliveries_from_location[current_location]++;
-            }else {
-                double delivery_time = append_delivery_delivery_time(param, sol, courier_state, closest_delivery);
-                if(courier_state.current_time + delivery_time > sol.max_delivery_delivery_time) {
-                    count_of_already_considered_closest_deliveries_from_location[current_location] = param.delivery_count;
-                    break;
+        // In sparse travel time mode the list only holds the deliveries in range of the location
+        const int* nearest_deliveries = param.location_nearest_delivery_matrix[current_location].data();
+        const uint64_t* capacity_mask = param.location_delivery_capacity_mask[param.courier_capacity_class[courier_state.courier_index - 1]].data();
+        size_t& first_word = location_first_unassigned_word[current_location];
+        size_t begin_word = param.location_delivery_bits_offset[current_location];
+        size_t end_word = param.location_delivery_bits_offset[current_location + 1];
+
+        while (first_word < end_word && location_unassigned_delivery_bits[first_word] == 0) first_word++;
+        for (size_t word = first_word; word < end_word; ++word) {
+            uint64_t candidate_bits = location_unassigned_delivery_bits[word] & capacity_mask[word];
+            while (candidate_bits != 0) {
+                int bit = __builtin_ctzll(candidate_bits);
+                candidate_bits &= candidate_bits - 1;
+                int closest_delivery = nearest_deliveries[64 * (word - begin_word) + bit];
+                if (sol.delivery_assigned_courier[closest_delivery - 1] != 0) {
+                    location_unassigned_delivery_bits[word] &= ~(uint64_t(1) << bit);
+                    continue;
                 }
+                return closest_delivery;
+            }
+        }
+        return 0;
+    }
+
+    CourierMove greedy_delivery_of_courier(const VRPPDParameters& param, const VRPPDSolution& sol, const CourierState& courier_state) {
+        int closest_delivery = nearest_candidate_delivery(param, sol, courier_state);
+        if (closest_delivery > 0) {
+            double delivery_time = append_delivery_delivery_time(param, sol, courier_state, closest_delivery);
+            if (courier_state.current_time + delivery_time <= sol.max_delivery_delivery_time) {
                 return CourierMove(courier_state.courier_index, closest_delivery, delivery_time, true);
             }
         }
@@ -87,14 +179,30 @@ public:
     }
 };
 
-void random_greedy_courier_heuristic(const VRPPDParameters& param, VRPPDSolution& sol) {
+// State of a courier at the end of its current route
+CourierState courier_state_of_solution(const VRPPDParameters& param, const VRPPDSolution& sol, int courier_index) {
+    int assigned_deliveries = sol.delivery_count_assigned_to_courier[courier_index - 1];
+    if (assigned_deliveries == 0) {
+        return CourierState(courier_index, param.courier_starting_location[courier_index - 1], 0);
+    }
+    int last_delivery = -sol.routing_plan[courier_index - 1][2 * assigned_deliveries - 1];
+    return CourierState(courier_index, param.delivery_dropoff_location[last_delivery - 1], sol.delivery_delivery_time[last_delivery - 1]);
+}
+
+// Completes the (possibly partial) solution by appending the deliveries with delivery_assigned_courier == 0
+// to the routes of the couriers
+void random_greedy_courier_heuristic(const VRPPDParameters& param, VRPPDSolution& sol, const AlgorithmConfig& algorithm_config) {
     sol.total_delivery_time = 0;
+    for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+        sol.total_delivery_time += sol.courier_attributed_delivery_time[courier_index - 1];
+    }
+    int deliveries_to_assign = std::count(sol.delivery_assigned_courier.begin(), sol.delivery_assigned_courier.end(), 0);
     
     GreedyDeliveryFinder greedy_delivery_finder_singleton(param);
 
     std::vector<CourierState> courier_states;
     for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
-        courier_states.emplace_back(courier_index, param.courier_starting_location[courier_index - 1], 0);
+        courier_states.push_back(courier_state_of_solution(param, sol, courier_index));
     }
 
     int iteration = 0;
@@ -103,15 +211,32 @@ void random_greedy_courier_heuristic(const VRPPDParameters& param, VRPPDSolution
     std::mt19937 gen(rd());
     std::uniform_real_distribution<> dis(0, 1);
     std::vector<CourierMove> greedy_courier_moves;
-    CourierMove greedy_courier_move(0, 0, 0, false);
+    AppendCostBatch append_cost_batch;
+    // Couriers without deliveries of one symmetry class all find the same move, only the first of them is
+    // queried in every round, so interchangeable couriers are used in index order
+    std::vector<int> symmetry_class_queried_round(param.symmetry_class_couriers.size(), 0);
     //std::cout << "Starting iterations 2" << std::endl;
-    while (assigned_deliveries < param.delivery_count) {
+    while (assigned_deliveries < deliveries_to_assign) {
         iteration++;
         
+        // The candidates of all couriers are collected first and their delivery times computed in one batch
         greedy_courier_moves.clear();
-        for (const auto& courier_state : courier_states) {
-            greedy_courier_move = greedy_delivery_finder_singleton.greedy_delivery_of_courier(param, sol, courier_state);
-            if (greedy_courier_move.delivery_index > 0) {greedy_courier_moves.push_back(greedy_courier_move);}
+        append_cost_batch.clear();
+        for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+            const CourierState& courier_state = courier_states[courier_index - 1];
+            if (sol.delivery_count_assigned_to_courier[courier_index - 1] == 0 && sol.courier_is_available[courier_index - 1]) {
+                int& queried_round = symmetry_class_queried_round[param.courier_symmetry_class[courier_index - 1]];
+                if (queried_round == iteration) continue;
+                queried_round = iteration;
+            }
+            int closest_delivery = greedy_delivery_finder_singleton.nearest_candidate_delivery(param, sol, courier_state);
+            if (closest_delivery > 0) append_cost_batch.push_back(param, courier_index, courier_state.current_location, courier_state.current_time, closest_delivery);
+        }
+        compute_append_delivery_times(param, append_cost_batch, sol.max_delivery_delivery_time);
+        for (size_t i = 0; i < append_cost_batch.size(); ++i) {
+            if (append_cost_batch.is_within_time_limit[i]) {
+                greedy_courier_moves.emplace_back(append_cost_batch.courier_index[i], append_cost_batch.delivery_index[i], append_cost_batch.delivery_time[i], true);
+            }
         }
         std::sort(greedy_courier_moves.begin(), greedy_courier_moves.end(),
                   [](const CourierMove& a, const CourierMove& b) { return a.cost < b.cost; });
@@ -122,18 +247,25 @@ void random_greedy_courier_heuristic(const VRPPDParameters& param, VRPPDSolution
         }
 
         for (const auto& courier_move : greedy_courier_moves) {
-            if (assigned_deliveries == param.delivery_count) break;
+            if (assigned_deliveries == deliveries_to_assign) break;
             double prob = random_probability_vector[courier_move.courier_index - 1];
             prob = prob * prob;
-            if (prob <= static_cast<double>(assigned_deliveries + 1) / param.delivery_count) {
+            if (prob <= static_cast<double>(assigned_deliveries + 1) / deliveries_to_assign) {
                 if (sol.delivery_assigned_courier[courier_move.delivery_index - 1] == 0) {
+                    if (algorithm_config.stack_pickup_groups) {
+                        std::vector<int> bundle = pickup_group_bundle(param, sol, courier_states[courier_move.courier_index - 1], courier_move);
+                        assigned_deliveries += bundle.size();
+                        apply_courier_bundle_move(param, sol, courier_states[courier_move.courier_index - 1], bundle);
+                        continue;
+                    }
                     sol.delivery_assigned_courier[courier_move.delivery_index - 1] = courier_move.courier_index;
                     assigned_deliveries++;
                     apply_courier_move(param, sol, courier_states[courier_move.courier_index - 1], courier_move);
                 }
             }
         }
-        if(iteration > 10000) {
+        // Without any candidate move the courier states cannot change anymore
+        if(iteration > 10000 || greedy_courier_moves.empty()) {
             sol.total_delivery_time = std::numeric_limits<double>::max();
             sol.is_feasible_solution = false;
             return;
@@ -62,13 +62,13 @@ bool is_feasible(const VRPPDParameters& param, const VRPPDSolution& sol) {
 
         for(int j = 0; j < 2*sol.delivery_count_assigned_to_courier[courier_index - 1]; j++) {
             if(sol.routing_plan[courier_index - 1][j] > 0) {
-                current_time += param.location_distance_matrix[current_location][param.delivery_pickup_location[sol.routing_plan[courier_index - 1][j] - 1]];
+                current_time += param.location_distance_matrix(current_location, param.delivery_pickup_location[sol.routing_plan[courier_index - 1][j] - 1]);
                 if(current_time < param.delivery_release_time[sol.routing_plan[courier_index - 1][j] - 1]) {
                     current_time = param.delivery_release_time[sol.routing_plan[courier_index - 1][j] - 1];
                 }
                 current_location = param.delivery_pickup_location[sol.routing_plan[courier_index - 1][j] - 1];
             }else if(sol.routing_plan[courier_index - 1][j] < 0) {
-                current_time += param.location_distance_matrix[current_location][param.delivery_dropoff_location[-sol.routing_plan[courier_index - 1][j] - 1]];
+                current_time += param.location_distance_matrix(current_location, param.delivery_dropoff_location[-sol.routing_plan[courier_index - 1][j] - 1]);
                 if(sol.delivery_delivery_time[-sol.routing_plan[courier_index - 1][j] - 1] > current_time) {
                     std::cout << "Delivery " << -sol.routing_plan[courier_index - 1][j] << " is delivered before the courier can reach it" << std::endl;
                     feasibility = false;
@@ -114,7 +114,7 @@ bool is_feasible(const VRPPDParameters& param, const VRPPDSolution& sol) {
         for (int j = 0; j < 2*sol.max_num_of_deliveries_assignable_to_courier; ++j) {
             if (sol.routing_plan[i][j] > 0) {
                 int delivery_pickup_location = param.delivery_pickup_location[sol.routing_plan[i][j] - 1];
-                current_time += param.location_distance_matrix[current_location][delivery_pickup_location];
+                current_time += param.location_distance_matrix(current_location, delivery_pickup_location);
                 if (current_time < param.delivery_release_time[sol.routing_plan[i][j] - 1]) {
                     current_time = param.delivery_release_time[sol.routing_plan[i][j] - 1];
                 }
@@ -122,7 +122,7 @@ bool is_feasible(const VRPPDParameters& param, const VRPPDSolution& sol) {
             }
             if (sol.routing_plan[i][j] < 0) {
                 int delivery_dropoff_location = param.delivery_dropoff_location[-sol.routing_plan[i][j] - 1];
-                current_time += param.location_distance_matrix[current_location][delivery_dropoff_location];
+                current_time += param.location_distance_matrix(current_location, delivery_dropoff_location);
                 if (sol.delivery_delivery_time[-sol.routing_plan[i][j] - 1] > current_time) {
                     std::cout << "Delivery " << -sol.routing_plan[i][j] << " is delivered before the courier can reach it" << std::endl;
                     feasibility = false;
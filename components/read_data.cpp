@@ -7,6 +7,8 @@
 #include <fstream>
 #include <sstream>
 #include <filesystem>
+#include <algorithm>
+#include "travel_time_matrix.h"
 
 class Courier {
 public:
@@ -103,14 +105,120 @@ std::vector<std::vector<double> > load_travel_time_from_csv(const std::string& f
     return travel_time;
 }
 
+// Reads the travel times row by row and only keeps the entries routes can use: per location the travel time
+// to itself, to its neighbour_count nearest pickup and dropoff locations and, for pickup locations, to the
+// dropoff locations of their deliveries. Every pickup location additionally keeps the travel times from its
+// neighbour_count nearest dropoff locations and courier starting locations, such that every delivery stays
+// reachable from the start of a route and after another delivery. Every row keeps O(neighbour_count) entries
+// plus the dropoffs of its pickups, the dense matrix is never held in memory.
+TravelTimeMatrix load_sparse_travel_time_from_csv(const std::string& filepath, int neighbour_count, const std::vector<Courier>& couriers, const std::vector<Delivery>& deliveries) {
+    std::vector<std::vector<std::pair<int, double> > > row_entries;
+    std::vector<std::vector<int> > pickup_dropoff_locations;
+    std::vector<int> pickup_locations, dropoff_locations, starting_locations;
+    for (const auto& delivery : deliveries) {
+        if (delivery.pickup_loc > static_cast<int>(pickup_dropoff_locations.size())) pickup_dropoff_locations.resize(delivery.pickup_loc);
+        pickup_dropoff_locations[delivery.pickup_loc - 1].push_back(delivery.dropoff_loc - 1);
+        pickup_locations.push_back(delivery.pickup_loc - 1);
+        dropoff_locations.push_back(delivery.dropoff_loc - 1);
+    }
+    for (const auto& courier : couriers) {
+        starting_locations.push_back(courier.location - 1);
+    }
+    for (auto* locations : {&pickup_locations, &dropoff_locations, &starting_locations}) {
+        std::sort(locations->begin(), locations->end());
+        locations->erase(std::unique(locations->begin(), locations->end()), locations->end());
+    }
+
+    // Max-heaps of the nearest dropoff and starting locations from which each pickup location is reached
+    typedef std::pair<double, int> HeapEntry;
+    std::vector<std::vector<HeapEntry> > pickup_nearest_dropoff_heaps(pickup_locations.size());
+    std::vector<std::vector<HeapEntry> > pickup_nearest_start_heaps(pickup_locations.size());
+    auto push_nearest = [neighbour_count](std::vector<HeapEntry>& heap, const HeapEntry& entry) {
+        if (static_cast<int>(heap.size()) < neighbour_count) {
+            heap.push_back(entry);
+            std::push_heap(heap.begin(), heap.end());
+        } else if (!heap.empty() && entry < heap.front()) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = entry;
+            std::push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    std::ifstream file(filepath);
+    std::string line;
+    std::vector<double> row;
+    std::vector<int> nearest_locations;
+    
+    // Skip header
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string token;
+        row.clear();
+
+        // Skip the first column (location index)
+        std::getline(iss, token, ',');
+
+        while (std::getline(iss, token, ',')) {
+            row.push_back(std::stoi(token));
+        }
+
+        int location = row_entries.size();
+        row_entries.emplace_back();
+        std::vector<std::pair<int, double> >& entries = row_entries.back();
+
+        for (const auto* locations : {&pickup_locations, &dropoff_locations}) {
+            nearest_locations.clear();
+            for (int j : *locations) {
+                if (j < static_cast<int>(row.size())) nearest_locations.push_back(j);
+            }
+            size_t kept_count = std::min<size_t>(neighbour_count, nearest_locations.size());
+            std::nth_element(nearest_locations.begin(), nearest_locations.begin() + kept_count, nearest_locations.end(),
+                [&](int a, int b) { return row[a] < row[b]; });
+            for (size_t j = 0; j < kept_count; ++j) entries.emplace_back(nearest_locations[j], row[nearest_locations[j]]);
+        }
+
+        if (location < static_cast<int>(row.size())) entries.emplace_back(location, row[location]);
+        if (location < static_cast<int>(pickup_dropoff_locations.size())) {
+            for (int dropoff_location : pickup_dropoff_locations[location]) {
+                entries.emplace_back(dropoff_location, row[dropoff_location]);
+            }
+        }
+
+        bool is_dropoff_location = std::binary_search(dropoff_locations.begin(), dropoff_locations.end(), location);
+        bool is_starting_location = std::binary_search(starting_locations.begin(), starting_locations.end(), location);
+        for (size_t k = 0; k < pickup_locations.size() && (is_dropoff_location || is_starting_location); ++k) {
+            if (pickup_locations[k] >= static_cast<int>(row.size())) continue;
+            HeapEntry entry(row[pickup_locations[k]], location);
+            if (is_dropoff_location) push_nearest(pickup_nearest_dropoff_heaps[k], entry);
+            if (is_starting_location) push_nearest(pickup_nearest_start_heaps[k], entry);
+        }
+    }
+
+    for (size_t k = 0; k < pickup_locations.size(); ++k) {
+        for (const auto* heap : {&pickup_nearest_dropoff_heaps[k], &pickup_nearest_start_heaps[k]}) {
+            for (const auto& entry : *heap) {
+                row_entries[entry.second].emplace_back(pickup_locations[k], entry.first);
+            }
+        }
+    }
+
+    return TravelTimeMatrix(row_entries);
+}
+
 struct VRPPDInstanceData {
     std::string instance_name;
     std::vector<Courier> couriers;
     std::vector<Delivery> deliveries;
     std::vector<std::vector<double> > travel_time;
+    // Used instead of travel_time if that is empty: the instance is loaded in sparse mode, or the library solves
+    // a matrix held by the caller
+    TravelTimeMatrix travel_time_matrix;
 };
 
-VRPPDInstanceData process_instance_folder(const std::string& instance_folder_path) {
+// With sparse_neighbour_count > 0 the travel times are loaded into a sparse matrix, see load_sparse_travel_time_from_csv
+VRPPDInstanceData process_instance_folder(const std::string& instance_folder_path, int sparse_neighbour_count = 0) {
     std::string couriers_file, deliveries_file, travel_time_file;
 
     for (const auto& entry : std::filesystem::directory_iterator(instance_folder_path)) {
@@ -132,7 +240,11 @@ VRPPDInstanceData process_instance_folder(const std::string& instance_folder_pat
     instance.instance_name = std::filesystem::path(instance_folder_path).filename().string();
     instance.couriers = load_couriers_from_csv(couriers_file);
     instance.deliveries = load_deliveries_from_csv(deliveries_file);
-    instance.travel_time = load_travel_time_from_csv(travel_time_file);
+    if (sparse_neighbour_count > 0) {
+        instance.travel_time_matrix = load_sparse_travel_time_from_csv(travel_time_file, sparse_neighbour_count, instance.couriers, instance.deliveries);
+    } else {
+        instance.travel_time = load_travel_time_from_csv(travel_time_file);
+    }
 
     return instance;
 }
@@ -0,0 +1,97 @@
+#ifndef READ_SOLUTION_CPP
+#define READ_SOLUTION_CPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include "vrppd_solution.h"
+#include "vrppd_parameters.h"
+#include "stack_courier_deliveries.cpp"
+
+// Reads a routing plan in the format of write_solution_to_csv (delivery IDs offset by courier_count,
+// first occurrence is the pickup, second the dropoff) and recomputes all times via apply_rerouting.
+VRPPDSolution read_solution_from_csv(const VRPPDParameters& param, const std::string& input_file_path) {
+    std::ifstream file(input_file_path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open solution file: " + input_file_path);
+    }
+
+    VRPPDSolution sol(param.courier_count, param.delivery_count);
+    // Every delivery must be picked up and dropped off, i.e. appear exactly twice in the row of its courier
+    std::vector<int> delivery_occurrence_count(param.delivery_count, 0);
+    std::vector<bool> is_courier_listed(param.courier_count, false);
+    std::string line;
+
+    // Skip header
+    std::getline(file, line);
+
+    while (std::getline(file, line)) {
+        std::istringstream iss(line);
+        std::string token;
+        std::vector<int> values;
+
+        while (std::getline(iss, token, ',')) {
+            if (!token.empty() && token != "\r") values.push_back(std::stoi(token));
+        }
+        if (values.empty()) continue;
+
+        int courier_index = values[0];
+        if (courier_index < 1 || courier_index > param.courier_count) {
+            throw std::runtime_error("Unknown courier " + std::to_string(courier_index) + " in solution file: " + input_file_path);
+        }
+        if (is_courier_listed[courier_index - 1]) {
+            throw std::runtime_error("Courier " + std::to_string(courier_index) + " is listed several times in solution file: " + input_file_path);
+        }
+        is_courier_listed[courier_index - 1] = true;
+        if (values.size() - 1 > 2 * static_cast<size_t>(sol.max_num_of_deliveries_assignable_to_courier)) {
+            throw std::runtime_error("Too many deliveries for courier " + std::to_string(courier_index) + " in solution file: " + input_file_path);
+        }
+
+        for (size_t i = 1; i < values.size(); ++i) {
+            int delivery_index = values[i] - param.courier_count;
+            if (delivery_index < 1 || delivery_index > param.delivery_count) {
+                throw std::runtime_error("Unknown delivery " + std::to_string(values[i]) + " in solution file: " + input_file_path);
+            }
+            if (++delivery_occurrence_count[delivery_index - 1] > 2) {
+                throw std::runtime_error("Delivery " + std::to_string(values[i]) + " appears more than twice in solution file: " + input_file_path);
+            }
+            if (sol.delivery_assigned_courier[delivery_index - 1] == 0) {
+                sol.delivery_assigned_courier[delivery_index - 1] = courier_index;
+                sol.delivery_count_assigned_to_courier[courier_index - 1]++;
+                sol.routing_plan[courier_index - 1][i - 1] = delivery_index;
+            } else if (sol.delivery_assigned_courier[delivery_index - 1] == courier_index) {
+                sol.routing_plan[courier_index - 1][i - 1] = -delivery_index;
+            } else {
+                throw std::runtime_error("Delivery " + std::to_string(values[i]) + " is assigned to several couriers in solution file: " + input_file_path);
+            }
+        }
+    }
+    file.close();
+    for (int i = 0; i < param.delivery_count; ++i) {
+        if (delivery_occurrence_count[i] == 1) {
+            throw std::runtime_error("Delivery " + std::to_string(i + 1 + param.courier_count) + " is picked up but not dropped off in solution file: " + input_file_path);
+        }
+    }
+
+    // Recompute delivery times and the objective from the parsed routes
+    sol.total_delivery_time = 0;
+    sol.is_feasible_solution = true;
+    for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+        if (delivery_time_of_rerouting(param, sol, courier_index, sol.routing_plan[courier_index - 1]) == std::numeric_limits<double>::max()) {
+            sol.is_feasible_solution = false;
+        }
+        apply_rerouting(param, sol, courier_index, sol.routing_plan[courier_index - 1]);
+    }
+    for (int i = 0; i < param.delivery_count; ++i) {
+        if (sol.delivery_assigned_courier[i] == 0) sol.is_feasible_solution = false;
+    }
+    if (!sol.is_feasible_solution) {
+        sol.total_delivery_time = std::numeric_limits<double>::max();
+    }
+
+    return sol;
+}
+
+#endif // READ_SOLUTION_CPP
@@ -0,0 +1,110 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include <array>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <algorithm>
+#include <unordered_map>
+
+// A courier route is fully determined by the starting location and capacity of the courier and by the set
+// of its deliveries, so the best stacking order of such a set can be reused across restarts.
+struct RouteCacheKey {
+    int starting_location;
+    int capacity;
+    int max_delivery_delivery_time;
+    std::array<int, 4> deliveries;
+
+    bool operator==(const RouteCacheKey& other) const {
+        return starting_location == other.starting_location && capacity == other.capacity
+            && max_delivery_delivery_time == other.max_delivery_delivery_time && deliveries == other.deliveries;
+    }
+};
+
+struct RouteCacheKeyHash {
+    size_t operator()(const RouteCacheKey& key) const {
+        size_t hash = std::hash<int>()(key.starting_location);
+        auto combine = [&hash](int value) { hash ^= std::hash<int>()(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2); };
+        combine(key.capacity);
+        combine(key.max_delivery_delivery_time);
+        for (int delivery : key.deliveries) combine(delivery);
+        return hash;
+    }
+};
+
+struct RouteCacheEntry {
+    std::array<int, 8> route;
+    double delivery_time;
+};
+
+// Thread safe cache with a bounded number of entries. The entries are spread over independently locked
+// shards, each of which evicts with the clock (second chance) policy.
+class RouteCache {
+private:
+    struct Slot {
+        RouteCacheKey key;
+        RouteCacheEntry entry;
+        bool is_referenced;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::vector<Slot> slots;
+        std::unordered_map<RouteCacheKey, size_t, RouteCacheKeyHash> slot_of_key;
+        size_t clock_hand = 0;
+    };
+
+    static const size_t shard_count = 16;
+    size_t slots_per_shard;
+    std::unique_ptr<Shard[]> shards;
+
+    Shard& shard_of_key(const RouteCacheKey& key) {
+        return shards[RouteCacheKeyHash()(key) % shard_count];
+    }
+
+public:
+    RouteCache(size_t capacity)
+        : slots_per_shard((capacity + shard_count - 1) / shard_count), shards(new Shard[shard_count]) {}
+
+    bool is_enabled() const { return slots_per_shard > 0; }
+
+    bool find(const RouteCacheKey& key, RouteCacheEntry& entry) {
+        Shard& shard = shard_of_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.slot_of_key.find(key);
+        if (it == shard.slot_of_key.end()) return false;
+        Slot& slot = shard.slots[it->second];
+        slot.is_referenced = true;
+        entry = slot.entry;
+        return true;
+    }
+
+    void insert(const RouteCacheKey& key, const RouteCacheEntry& entry) {
+        if (!is_enabled()) return;
+        Shard& shard = shard_of_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.slot_of_key.find(key);
+        if (it != shard.slot_of_key.end()) {
+            shard.slots[it->second].entry = entry;
+            return;
+        }
+        if (shard.slots.size() < slots_per_shard) {
+            shard.slot_of_key[key] = shard.slots.size();
+            shard.slots.push_back(Slot{key, entry, false});
+            return;
+        }
+        // Clock sweep: recently referenced slots get a second chance
+        while (shard.slots[shard.clock_hand].is_referenced) {
+            shard.slots[shard.clock_hand].is_referenced = false;
+            shard.clock_hand = (shard.clock_hand + 1) % slots_per_shard;
+        }
+        Slot& victim = shard.slots[shard.clock_hand];
+        shard.slot_of_key.erase(victim.key);
+        victim = Slot{key, entry, false};
+        shard.slot_of_key[key] = shard.clock_hand;
+        shard.clock_hand = (shard.clock_hand + 1) % slots_per_shard;
+    }
+};
+
+#endif // ROUTE_CACHE_H
@@ -0,0 +1,321 @@
+#ifndef ROUTE_POOL_CPP
+#define ROUTE_POOL_CPP
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <chrono>
+#include <unordered_set>
+#include "vrppd_parameters.h"
+#include "vrppd_solution.h"
+#include "algorithm_config.h"
+#include "stack_courier_deliveries.cpp"
+#include "heuristic_generator.cpp"
+
+struct PooledRoute {
+    int symmetry_class;
+    std::vector<int> route;
+    std::vector<int> deliveries;
+    double delivery_time;
+    // Routes of the best solution added so far are never evicted
+    bool is_in_best_solution = false;
+};
+
+// Collects the distinct stacked routes of feasible solutions and recombines them by solving the set
+// partitioning problem: pick at most one route per courier such that every delivery is covered once. A route
+// serves every courier of the symmetry class it was found for, so the routes are pooled per class.
+class RoutePool {
+private:
+    size_t routes_per_courier;
+    std::vector<std::vector<PooledRoute> > class_routes;
+    std::vector<std::unordered_set<size_t> > class_route_hashes;
+    // Number of pooled routes covering each delivery
+    std::vector<int> delivery_route_count;
+    double best_delivery_time = std::numeric_limits<double>::max();
+
+    static size_t delivery_set_hash(const std::vector<int>& deliveries) {
+        size_t hash = deliveries.size();
+        for (int delivery : deliveries) hash ^= std::hash<int>()(delivery) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        return hash;
+    }
+
+    static double delivery_time_per_delivery(const PooledRoute& route) {
+        return route.delivery_time / route.deliveries.size();
+    }
+
+    // Position of the route with the given sorted deliveries in the pool of its class, or -1
+    int find_route(int symmetry_class, const std::vector<int>& deliveries) const {
+        const std::vector<PooledRoute>& routes = class_routes[symmetry_class];
+        for (size_t r = 0; r < routes.size(); ++r) {
+            if (routes[r].deliveries == deliveries) return r;
+        }
+        return -1;
+    }
+
+    void count_route_deliveries(const PooledRoute& route, int change) {
+        for (int delivery : route.deliveries) delivery_route_count[delivery - 1] += change;
+    }
+
+    // Routes of a feasible, stacked solution, one per courier with deliveries
+    static std::vector<PooledRoute> routes_of_solution(const VRPPDParameters& param, const VRPPDSolution& sol) {
+        std::vector<PooledRoute> routes;
+        for (int courier = 0; courier < param.courier_count; ++courier) {
+            int assigned_deliveries = sol.delivery_count_assigned_to_courier[courier];
+            if (assigned_deliveries == 0) continue;
+            PooledRoute pooled_route{param.courier_symmetry_class[courier],
+                std::vector<int>(sol.routing_plan[courier].begin(), sol.routing_plan[courier].begin() + 2 * assigned_deliveries),
+                {}, sol.courier_attributed_delivery_time[courier]};
+            for (int stop : pooled_route.route) {
+                if (stop > 0) pooled_route.deliveries.push_back(stop);
+            }
+            std::sort(pooled_route.deliveries.begin(), pooled_route.deliveries.end());
+            routes.push_back(std::move(pooled_route));
+        }
+        return routes;
+    }
+
+public:
+    RoutePool(const VRPPDParameters& param, size_t routes_per_courier)
+        : routes_per_courier(routes_per_courier), class_routes(param.symmetry_class_couriers.size()), class_route_hashes(param.symmetry_class_couriers.size()),
+          delivery_route_count(param.delivery_count, 0) {}
+
+    size_t size() const {
+        size_t route_count = 0;
+        for (const auto& routes : class_routes) route_count += routes.size();
+        return route_count;
+    }
+
+    // Adds the routes of a feasible, stacked solution. A full class pool replaces its route with the highest
+    // delivery time per delivery if the new route is better. Routes of the best solution and routes which are
+    // the last cover of one of their deliveries are not replaced, and the routes of a new best solution are
+    // always added, so the pool always contains a complete partition.
+    void add_solution(const VRPPDParameters& param, const VRPPDSolution& sol) {
+        if (!sol.is_feasible_solution || routes_per_courier == 0) return;
+        bool is_best_solution = sol.total_delivery_time < best_delivery_time;
+        if (is_best_solution) {
+            best_delivery_time = sol.total_delivery_time;
+            for (auto& routes : class_routes) {
+                for (auto& route : routes) route.is_in_best_solution = false;
+            }
+        }
+
+        for (PooledRoute& pooled_route : routes_of_solution(param, sol)) {
+            int symmetry_class = pooled_route.symmetry_class;
+            std::vector<PooledRoute>& routes = class_routes[symmetry_class];
+            pooled_route.is_in_best_solution = is_best_solution;
+            size_t hash = delivery_set_hash(pooled_route.deliveries);
+            if (class_route_hashes[symmetry_class].count(hash)) {
+                int r = is_best_solution ? find_route(symmetry_class, pooled_route.deliveries) : -1;
+                if (r >= 0) routes[r].is_in_best_solution = true;
+                continue;
+            }
+
+            PooledRoute* worst_route = nullptr;
+            if (routes.size() >= routes_per_courier * param.symmetry_class_couriers[symmetry_class].size()) {
+                for (auto& route : routes) {
+                    if (route.is_in_best_solution || (worst_route != nullptr && delivery_time_per_delivery(route) <= delivery_time_per_delivery(*worst_route))) continue;
+                    bool is_last_cover = std::any_of(route.deliveries.begin(), route.deliveries.end(),
+                        [&](int delivery) { return delivery_route_count[delivery - 1] == 1; });
+                    if (!is_last_cover) worst_route = &route;
+                }
+                if (!is_best_solution && (worst_route == nullptr || delivery_time_per_delivery(pooled_route) >= delivery_time_per_delivery(*worst_route))) continue;
+            }
+
+            count_route_deliveries(pooled_route, 1);
+            class_route_hashes[symmetry_class].insert(hash);
+            if (worst_route != nullptr) {
+                count_route_deliveries(*worst_route, -1);
+                class_route_hashes[symmetry_class].erase(delivery_set_hash(worst_route->deliveries));
+                *worst_route = std::move(pooled_route);
+            } else {
+                routes.push_back(std::move(pooled_route));
+            }
+        }
+    }
+
+    // Depth first branch and bound on the uncovered delivery with the fewest routes which are still compatible
+    // with the chosen ones. Candidate routes are tried in order of delivery time per delivery, the lower bound
+    // charges every uncovered delivery its cheapest share of a route. The incumbent solution is the first best
+    // partition, so only cheaper ones are searched. Stops after route_pool_node_limit nodes or at the deadline.
+    // Without a cheaper partition, the routes of a greedy dive are completed by the random greedy heuristic,
+    // which may or may not beat the incumbent. If that fails, the incumbent's pooled routes are returned.
+    VRPPDSolution solve_set_partitioning(const VRPPDParameters& param, const VRPPDSolution& empty_solution, const VRPPDSolution& incumbent_solution,
+                                         const AlgorithmConfig& algorithm_config, std::chrono::steady_clock::time_point deadline) const {
+        std::vector<const PooledRoute*> routes;
+        std::vector<std::vector<int> > class_route_indices(class_routes.size());
+        for (size_t symmetry_class = 0; symmetry_class < class_routes.size(); ++symmetry_class) {
+            for (const auto& route : class_routes[symmetry_class]) {
+                class_route_indices[symmetry_class].push_back(routes.size());
+                routes.push_back(&route);
+            }
+        }
+
+        std::vector<std::vector<int> > delivery_routes(param.delivery_count);
+        std::vector<double> delivery_lower_bound(param.delivery_count, 0);
+        for (size_t r = 0; r < routes.size(); ++r) {
+            for (int delivery : routes[r]->deliveries) delivery_routes[delivery - 1].push_back(r);
+        }
+        for (int d = 0; d < param.delivery_count; ++d) {
+            std::sort(delivery_routes[d].begin(), delivery_routes[d].end(), [&](int a, int b) {
+                return delivery_time_per_delivery(*routes[a]) < delivery_time_per_delivery(*routes[b]);
+            });
+            if (!delivery_routes[d].empty()) delivery_lower_bound[d] = delivery_time_per_delivery(*routes[delivery_routes[d][0]]);
+        }
+
+        // Every route takes one of the available couriers of its class. A route is compatible while its class
+        // has a free courier and none of its deliveries is covered.
+        std::vector<int> class_free_couriers(param.symmetry_class_couriers.size(), 0);
+        for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+            if (empty_solution.courier_is_available[courier_index - 1]) class_free_couriers[param.courier_symmetry_class[courier_index - 1]]++;
+        }
+        std::vector<bool> is_delivery_covered(param.delivery_count, false);
+        std::vector<int> route_covered_delivery_count(routes.size(), 0);
+        std::vector<int> compatible_route_count(param.delivery_count, 0);
+        auto is_compatible = [&](int r) { return route_covered_delivery_count[r] == 0 && class_free_couriers[routes[r]->symmetry_class] > 0; };
+        auto count_compatible_route = [&](int r, int change) {
+            for (int delivery : routes[r]->deliveries) compatible_route_count[delivery - 1] += change;
+        };
+        for (size_t r = 0; r < routes.size(); ++r) {
+            if (is_compatible(r)) count_compatible_route(r, 1);
+        }
+        double remaining_lower_bound = 0;
+        for (int d = 0; d < param.delivery_count; ++d) remaining_lower_bound += delivery_lower_bound[d];
+
+        auto choose_route = [&](int r) {
+            const PooledRoute& route = *routes[r];
+            if (--class_free_couriers[route.symmetry_class] == 0) {
+                for (int class_route : class_route_indices[route.symmetry_class]) {
+                    if (route_covered_delivery_count[class_route] == 0) count_compatible_route(class_route, -1);
+                }
+            }
+            for (int delivery : route.deliveries) {
+                is_delivery_covered[delivery - 1] = true;
+                remaining_lower_bound -= delivery_lower_bound[delivery - 1];
+                for (int delivery_route : delivery_routes[delivery - 1]) {
+                    if (route_covered_delivery_count[delivery_route]++ == 0 && class_free_couriers[routes[delivery_route]->symmetry_class] > 0) {
+                        count_compatible_route(delivery_route, -1);
+                    }
+                }
+            }
+        };
+        auto unchoose_route = [&](int r) {
+            const PooledRoute& route = *routes[r];
+            for (int delivery : route.deliveries) {
+                is_delivery_covered[delivery - 1] = false;
+                remaining_lower_bound += delivery_lower_bound[delivery - 1];
+                for (int delivery_route : delivery_routes[delivery - 1]) {
+                    if (--route_covered_delivery_count[delivery_route] == 0 && class_free_couriers[routes[delivery_route]->symmetry_class] > 0) {
+                        count_compatible_route(delivery_route, 1);
+                    }
+                }
+            }
+            if (class_free_couriers[route.symmetry_class]++ == 0) {
+                for (int class_route : class_route_indices[route.symmetry_class]) {
+                    if (route_covered_delivery_count[class_route] == 0) count_compatible_route(class_route, 1);
+                }
+            }
+        };
+        // Uncovered delivery with the fewest compatible routes, ignoring deliveries without any if requested.
+        // Returns -1 if all deliveries are covered.
+        auto branching_delivery = [&](bool skips_uncoverable) {
+            int best_delivery = -1;
+            for (int d = 0; d < param.delivery_count; ++d) {
+                if (is_delivery_covered[d] || (skips_uncoverable && compatible_route_count[d] == 0)) continue;
+                if (best_delivery < 0 || compatible_route_count[d] < compatible_route_count[best_delivery]) best_delivery = d;
+            }
+            return best_delivery;
+        };
+
+        // The incumbent is the first best partition if all its routes are pooled, otherwise only the upper bound
+        std::vector<int> chosen_routes, best_routes;
+        double best_cost = incumbent_solution.is_feasible_solution ? incumbent_solution.total_delivery_time : std::numeric_limits<double>::max();
+        if (incumbent_solution.is_feasible_solution) {
+            for (const PooledRoute& incumbent_route : routes_of_solution(param, incumbent_solution)) {
+                int r = find_route(incumbent_route.symmetry_class, incumbent_route.deliveries);
+                if (r < 0) {
+                    best_routes.clear();
+                    break;
+                }
+                best_routes.push_back(class_route_indices[incumbent_route.symmetry_class][r]);
+            }
+        }
+        bool is_improved = false;
+        int node_count = 0;
+        bool is_stopped = false;
+
+        auto branch = [&](auto&& self, double cost) -> void {
+            if (node_count++ >= algorithm_config.route_pool_node_limit || (node_count % 1024 == 0 && std::chrono::steady_clock::now() >= deadline)) {
+                is_stopped = true;
+                return;
+            }
+            int delivery = branching_delivery(false);
+            if (delivery < 0) {
+                if (cost < best_cost - 1e-6) {
+                    best_cost = cost;
+                    best_routes = chosen_routes;
+                    is_improved = true;
+                }
+                return;
+            }
+            if (compatible_route_count[delivery] == 0) return;
+            for (int r : delivery_routes[delivery]) {
+                if (!is_compatible(r)) continue;
+                const PooledRoute& route = *routes[r];
+                double route_lower_bound = 0;
+                for (int route_delivery : route.deliveries) route_lower_bound += delivery_lower_bound[route_delivery - 1];
+                if (cost + route.delivery_time + remaining_lower_bound - route_lower_bound >= best_cost - 1e-6) continue;
+
+                choose_route(r);
+                chosen_routes.push_back(r);
+                self(self, cost + route.delivery_time);
+                chosen_routes.pop_back();
+                unchoose_route(r);
+                if (is_stopped) return;
+            }
+        };
+        branch(branch, 0.0);
+
+        // The routes of a class go to its available couriers in index order
+        auto solution_of_routes = [&](const std::vector<int>& partition_routes) {
+            VRPPDSolution sol = empty_solution;
+            std::vector<size_t> class_next_courier(param.symmetry_class_couriers.size(), 0);
+            sol.total_delivery_time = 0;
+            for (int r : partition_routes) {
+                const PooledRoute& route = *routes[r];
+                const std::vector<int>& couriers = param.symmetry_class_couriers[route.symmetry_class];
+                size_t& next_courier = class_next_courier[route.symmetry_class];
+                while (!sol.courier_is_available[couriers[next_courier] - 1]) next_courier++;
+                int courier_index = couriers[next_courier++];
+
+                sol.delivery_count_assigned_to_courier[courier_index - 1] = route.deliveries.size();
+                for (int delivery : route.deliveries) sol.delivery_assigned_courier[delivery - 1] = courier_index;
+                std::vector<int> routing_plan_row(2 * sol.max_num_of_deliveries_assignable_to_courier, 0);
+                std::copy(route.route.begin(), route.route.end(), routing_plan_row.begin());
+                apply_rerouting(param, sol, courier_index, routing_plan_row);
+                sol.courier_route_is_stacked[courier_index - 1] = true;
+            }
+            sol.is_feasible_solution = !partition_routes.empty() && std::count(sol.delivery_assigned_courier.begin(), sol.delivery_assigned_courier.end(), 0) == 0;
+            return sol;
+        };
+        if (is_improved) return solution_of_routes(best_routes);
+
+        // Greedy dive: the cheapest compatible route of the most constrained delivery, deliveries without any
+        // compatible route are left to the random greedy heuristic
+        std::vector<int> dive_routes;
+        for (int delivery = branching_delivery(true); delivery >= 0; delivery = branching_delivery(true)) {
+            for (int r : delivery_routes[delivery]) {
+                if (!is_compatible(r)) continue;
+                choose_route(r);
+                dive_routes.push_back(r);
+                break;
+            }
+        }
+        VRPPDSolution sol = solution_of_routes(dive_routes);
+        random_greedy_courier_heuristic(param, sol, algorithm_config);
+        if (sol.is_feasible_solution) stack_all_courier_deliveries(param, sol);
+        if (sol.is_feasible_solution || best_routes.empty()) return sol;
+        return solution_of_routes(best_routes);
+    }
+};
+
+#endif // ROUTE_POOL_CPP
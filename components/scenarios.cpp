@@ -0,0 +1,113 @@
+#ifndef SCENARIOS_CPP
+#define SCENARIOS_CPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <atomic>
+#include <thread>
+#include <filesystem>
+#include "vrppd_parameters.h"
+#include "vrppd_solution.h"
+#include "algorithm_config.h"
+#include "is_feasible.cpp"
+#include "write_solution.cpp"
+#include "solver.cpp"
+
+struct VRPPDScenario {
+    std::string name;
+    AlgorithmConfig algorithm_config;
+};
+
+struct VRPPDScenarioResult {
+    bool is_feasible = false;
+    double total_delivery_time = std::numeric_limits<double>::max();
+    int iterations = 0;
+    std::string error;
+};
+
+// Reads one scenario per line: "<name> key=value ...". Every scenario starts from the base config, empty
+// lines and lines starting with # are skipped. The instance is shared, so the entries which change its
+// preprocessing cannot differ between scenarios.
+std::vector<VRPPDScenario> read_scenarios(const std::string& scenario_file_path, const AlgorithmConfig& base_config) {
+    std::ifstream file(scenario_file_path);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open scenario file: " + scenario_file_path);
+    }
+
+    std::vector<VRPPDScenario> scenarios;
+    std::set<std::string> scenario_names;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream line_stream(line);
+        VRPPDScenario scenario{"", base_config};
+        if (!(line_stream >> scenario.name) || scenario.name[0] == '#') continue;
+        if (scenario.name.find('/') != std::string::npos || !scenario_names.insert(scenario.name).second) {
+            throw std::runtime_error("Invalid or duplicate scenario name: " + scenario.name);
+        }
+        std::string entry;
+        while (line_stream >> entry) {
+            if (!scenario.algorithm_config.set_entry(entry)) {
+                throw std::runtime_error("Unknown config entry in scenario " + scenario.name + ": " + entry);
+            }
+        }
+        if (scenario.algorithm_config.renumber_locations != base_config.renumber_locations ||
+            scenario.algorithm_config.sparse_travel_time_neighbours != base_config.sparse_travel_time_neighbours) {
+            throw std::runtime_error("Scenario " + scenario.name + " changes the instance preprocessing");
+        }
+        scenarios.push_back(scenario);
+    }
+    return scenarios;
+}
+
+// Solves all scenarios on the shared, read-only instance parameters with up to one thread per core. Writes
+// <output_folder>/<name>.csv for every feasible scenario and the objectives of all scenarios to
+// <output_folder>/scenario_summary.csv.
+std::vector<VRPPDScenarioResult> solve_scenarios(const VRPPDParameters& param, const std::string& instance_name,
+                                                 const std::vector<VRPPDScenario>& scenarios, const std::string& output_folder) {
+    std::filesystem::create_directories(output_folder);
+    std::vector<VRPPDScenarioResult> results(scenarios.size());
+    std::vector<VRPPDSolution> solutions(scenarios.size(), VRPPDSolution(param.courier_count, param.delivery_count));
+
+    std::atomic<size_t> next_scenario(0);
+    auto solve_next_scenarios = [&]() {
+        for (size_t i = next_scenario++; i < scenarios.size(); i = next_scenario++) {
+            try {
+                SolverStatistics statistics;
+                VRPPDSolution warm_start_solution = load_warm_start_solution(param, scenarios[i].algorithm_config, instance_name);
+                solutions[i] = solve_vrppd(param, scenarios[i].algorithm_config, warm_start_solution, statistics);
+                results[i].iterations = statistics.iterations;
+            } catch (const std::exception& e) {
+                results[i].error = e.what();
+            }
+        }
+    };
+    size_t thread_count = std::min<size_t>(scenarios.size(), std::max(1u, std::thread::hardware_concurrency()));
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < thread_count; ++t) threads.emplace_back(solve_next_scenarios);
+    for (auto& thread : threads) thread.join();
+
+    std::ofstream summary_file(std::filesystem::path(output_folder) / "scenario_summary.csv");
+    summary_file << "Scenario,Feasible,Total delivery time,Iterations,Error" << std::endl;
+    for (size_t i = 0; i < scenarios.size(); ++i) {
+        VRPPDScenarioResult& result = results[i];
+        if (result.error.empty() && is_feasible(param, solutions[i])) {
+            result.is_feasible = true;
+            result.total_delivery_time = solutions[i].total_delivery_time;
+            write_solution_to_csv(param, solutions[i], (std::filesystem::path(output_folder) / (scenarios[i].name + ".csv")).string());
+        } else if (result.error.empty()) {
+            result.error = "No feasible solution found";
+        }
+        summary_file << scenarios[i].name << "," << (result.is_feasible ? "true" : "false") << ","
+                     << (result.is_feasible ? std::to_string(result.total_delivery_time) : "") << ","
+                     << result.iterations << "," << result.error << std::endl;
+        std::cout << "Scenario " << scenarios[i].name << ": "
+                  << (result.is_feasible ? std::to_string(result.total_delivery_time) : result.error) << std::endl;
+    }
+    return results;
+}
+
+#endif // SCENARIOS_CPP
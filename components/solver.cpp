@@ -0,0 +1,211 @@
+#ifndef SOLVER_CPP
+#define SOLVER_CPP
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include "vrppd_parameters.h"
+#include "vrppd_solution.h"
+#include "algorithm_config.h"
+#include "stack_courier_deliveries.cpp"
+#include "heuristic_generator.cpp"
+#include "decomposition.cpp"
+#include "assignment_heuristic.cpp"
+#include "read_solution.cpp"
+#include "route_pool.cpp"
+
+struct SolverStatistics {
+    int iterations = 0;
+    double warm_start_delivery_time = std::numeric_limits<double>::max();
+    double constructor_delivery_time = std::numeric_limits<double>::max();
+    double elapsed_seconds = 0;
+    int duplicate_restarts = 0;
+};
+
+// Loads the warm start configured for the instance, returns an infeasible empty solution if there is none
+VRPPDSolution load_warm_start_solution(const VRPPDParameters& param, const AlgorithmConfig& algorithm_config, const std::string& instance_name) {
+    VRPPDSolution warm_start_solution(param.courier_count, param.delivery_count);
+    if (algorithm_config.warm_start_solution.empty()) return warm_start_solution;
+
+    // A folder such as FINAL_SOLUTIONS/ holds one <instance_name>.csv per instance
+    std::string warm_start_file = algorithm_config.warm_start_solution;
+    if (std::filesystem::is_directory(warm_start_file)) {
+        warm_start_file = (std::filesystem::path(warm_start_file) / (instance_name + ".csv")).string();
+    }
+    if (std::filesystem::exists(warm_start_file)) {
+        warm_start_solution = read_solution_from_csv(param, warm_start_file);
+        if (!warm_start_solution.is_feasible_solution) {
+            std::cout << "Warm start solution is not feasible: " << warm_start_file << std::endl;
+        }
+    } else {
+        std::cout << "Warm start solution not found: " << warm_start_file << std::endl;
+    }
+    return warm_start_solution;
+}
+
+// Empty solution with the route limits and the courier subset of the config
+VRPPDSolution empty_solution_of_config(const VRPPDParameters& param, const AlgorithmConfig& algorithm_config) {
+    VRPPDSolution sol(param.courier_count, param.delivery_count, algorithm_config.max_deliveries_per_courier, algorithm_config.max_delivery_time);
+    if (!algorithm_config.couriers.empty()) {
+        std::fill(sol.courier_is_available.begin(), sol.courier_is_available.end(), false);
+        for (int courier_index : algorithm_config.couriers) {
+            if (courier_index < 1 || courier_index > param.courier_count) {
+                throw std::runtime_error("Unknown courier in courier subset: " + std::to_string(courier_index));
+            }
+            sol.courier_is_available[courier_index - 1] = true;
+        }
+    }
+    return sol;
+}
+
+// Moves the routes of a solution into the empty solution of the config, returns false if the solution breaks
+// the route limits or uses couriers outside the courier subset
+bool adopt_solution_into_config(const VRPPDSolution& sol, VRPPDSolution& empty_solution) {
+    for (size_t courier = 0; courier < sol.routing_plan.size(); ++courier) {
+        int assigned_deliveries = sol.delivery_count_assigned_to_courier[courier];
+        if (assigned_deliveries == 0) continue;
+        if (assigned_deliveries > empty_solution.max_num_of_deliveries_assignable_to_courier || !empty_solution.courier_is_available[courier]) return false;
+    }
+    for (double delivery_time : sol.delivery_delivery_time) {
+        if (delivery_time > empty_solution.max_delivery_delivery_time) return false;
+    }
+    VRPPDSolution adopted_solution = sol;
+    adopted_solution.max_num_of_deliveries_assignable_to_courier = empty_solution.max_num_of_deliveries_assignable_to_courier;
+    adopted_solution.max_delivery_delivery_time = empty_solution.max_delivery_delivery_time;
+    for (auto& route : adopted_solution.routing_plan) route.resize(2 * adopted_solution.max_num_of_deliveries_assignable_to_courier, 0);
+    adopted_solution.courier_is_available = empty_solution.courier_is_available;
+    empty_solution = adopted_solution;
+    return true;
+}
+
+// Signature of a solution which is invariant under swapping the routes of interchangeable couriers: the
+// unordered collection of (symmetry class, delivery set) pairs of all routes
+size_t canonical_solution_signature(const VRPPDParameters& param, const VRPPDSolution& sol) {
+    auto mix = [](size_t value) {
+        value += 0x9e3779b97f4a7c15ULL;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+        return value ^ (value >> 31);
+    };
+    size_t signature = 0;
+    std::vector<int> deliveries;
+    for (int courier = 0; courier < param.courier_count; ++courier) {
+        deliveries.clear();
+        for (int i = 0; i < 2 * sol.delivery_count_assigned_to_courier[courier]; ++i) {
+            if (sol.routing_plan[courier][i] > 0) deliveries.push_back(sol.routing_plan[courier][i]);
+        }
+        if (deliveries.empty()) continue;
+        std::sort(deliveries.begin(), deliveries.end());
+        size_t route_hash = mix(param.courier_symmetry_class[courier]);
+        for (int delivery : deliveries) route_hash = mix(route_hash ^ delivery);
+        signature += route_hash;
+    }
+    return signature;
+}
+
+// Runs the restart loop until the deadline and returns the best solution found
+VRPPDSolution solve_vrppd(const VRPPDParameters& param, const AlgorithmConfig& algorithm_config, const VRPPDSolution& warm_start_solution, SolverStatistics& statistics, std::chrono::steady_clock::time_point deadline) {
+    auto time_start = std::chrono::steady_clock::now();
+
+    const VRPPDSolution empty_solution = empty_solution_of_config(param, algorithm_config);
+    VRPPDSolution best_solution = empty_solution,
+                  incumbent_solution = empty_solution;
+
+    int available_courier_count = std::count(empty_solution.courier_is_available.begin(), empty_solution.courier_is_available.end(), true);
+    if (empty_solution.max_num_of_deliveries_assignable_to_courier * available_courier_count < param.delivery_count) {
+        throw std::runtime_error("The number of couriers per delivery is too low");
+    }
+
+    RouteCache route_cache(algorithm_config.route_cache_size);
+    RoutePool route_pool(param, algorithm_config.route_pool_size);
+    // Restarts which only permute the routes among interchangeable couriers of a known solution are skipped
+    // The signatures of recent restarts are kept in a fixed size direct-mapped table, a signature evicts the
+    // older one of its slot. 0 marks an empty slot, a real signature of 0 would merely skip that restart.
+    std::vector<size_t> restart_signatures(1 << 16, 0);
+    auto is_duplicate_restart = [&](size_t signature) {
+        size_t& slot = restart_signatures[signature & (restart_signatures.size() - 1)];
+        if (slot == signature) return true;
+        slot = signature;
+        return false;
+    };
+
+    // Recombines the pooled routes of all restarts so far into a solution better than the best one, if any
+    auto recombine_route_pool = [&]() {
+        // The loop ends at the deadline, so there is no final recombination after it
+        if (algorithm_config.route_pool_size <= 0 || std::chrono::steady_clock::now() >= deadline) return;
+        VRPPDSolution recombined_solution = route_pool.solve_set_partitioning(param, empty_solution, best_solution, algorithm_config, deadline);
+        if (recombined_solution.is_feasible_solution && recombined_solution.total_delivery_time < best_solution.total_delivery_time) {
+            best_solution = recombined_solution;
+            route_pool.add_solution(param, best_solution);
+        }
+    };
+
+    if (warm_start_solution.is_feasible_solution && !adopt_solution_into_config(warm_start_solution, incumbent_solution)) {
+        std::cout << "Warm start solution breaks the route limits or courier subset and is ignored" << std::endl;
+    } else if (warm_start_solution.is_feasible_solution) {
+        stack_all_courier_deliveries(param, incumbent_solution, &route_cache);
+        best_solution = incumbent_solution;
+        route_pool.add_solution(param, incumbent_solution);
+        statistics.warm_start_delivery_time = best_solution.total_delivery_time;
+    }
+
+    if (algorithm_config.constructor == "matching") {
+        incumbent_solution = empty_solution;
+        matching_courier_heuristic(param, incumbent_solution, algorithm_config);
+        if (incumbent_solution.is_feasible_solution) stack_all_courier_deliveries(param, incumbent_solution, &route_cache);
+        route_pool.add_solution(param, incumbent_solution);
+        if (incumbent_solution.total_delivery_time < best_solution.total_delivery_time) {
+            best_solution = incumbent_solution;
+        }
+        statistics.constructor_delivery_time = incumbent_solution.total_delivery_time;
+    } else if (algorithm_config.constructor != "greedy") {
+        throw std::runtime_error("Unknown constructor: " + algorithm_config.constructor);
+    }
+
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::unique_ptr<DecomposedGreedyHeuristic> decomposed_greedy_heuristic;
+    if (algorithm_config.decomposition_clusters > 1) {
+        decomposed_greedy_heuristic = std::make_unique<DecomposedGreedyHeuristic>(param, algorithm_config, empty_solution);
+    }
+
+    int iteration = 0;
+    // std::cout << "Starting iterations" << std::endl;
+    while(true){
+        if (std::chrono::steady_clock::now() >= deadline) break;
+        //if(iteration >= 1000) break;
+        //std::cout << "Iteration " << iteration << ": start ";
+        iteration++;
+        incumbent_solution = empty_solution;
+        if (algorithm_config.decomposition_clusters > 1) {
+            decomposed_greedy_heuristic->construct(incumbent_solution, gen);
+        } else {
+            random_greedy_courier_heuristic(param, incumbent_solution, algorithm_config);
+        }
+        if (incumbent_solution.is_feasible_solution && is_duplicate_restart(canonical_solution_signature(param, incumbent_solution))) {
+            statistics.duplicate_restarts++;
+        } else {
+            if(incumbent_solution.is_feasible_solution) stack_all_courier_deliveries(param, incumbent_solution, &route_cache);
+            //std::cout << " -> 3" << std::endl;
+            route_pool.add_solution(param, incumbent_solution);
+            if (incumbent_solution.total_delivery_time < best_solution.total_delivery_time) {
+                best_solution = incumbent_solution;
+            }
+        }
+        if (algorithm_config.route_pool_interval > 0 && iteration % algorithm_config.route_pool_interval == 0) recombine_route_pool();
+        //std::cout << "Iteration " << iteration << " done" << std::endl;
+    }
+
+    statistics.iterations = iteration;
+    statistics.elapsed_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+    return best_solution;
+}
+
+// Runs the restart loop for the time limit of the config
+VRPPDSolution solve_vrppd(const VRPPDParameters& param, const AlgorithmConfig& algorithm_config, const VRPPDSolution& warm_start_solution, SolverStatistics& statistics) {
+    return solve_vrppd(param, algorithm_config, warm_start_solution, statistics, std::chrono::steady_clock::now() + std::chrono::seconds(algorithm_config.time_limit));
+}
+
+#endif // SOLVER_CPP
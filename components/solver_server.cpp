@@ -0,0 +1,142 @@
+#ifndef SOLVER_SERVER_CPP
+#define SOLVER_SERVER_CPP
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <list>
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <filesystem>
+#include "vrppd_parameters.h"
+#include "vrppd_solution.h"
+#include "algorithm_config.h"
+#include "read_data.cpp"
+#include "write_solution.cpp"
+#include "solver.cpp"
+
+struct CachedInstance {
+    std::string instance_name;
+    std::filesystem::file_time_type modification_time;
+    std::shared_ptr<const VRPPDParameters> param;
+};
+
+// LRU cache of preprocessed instances keyed by instance folder path, preprocessing options and modification time
+class InstanceCache {
+private:
+    size_t capacity;
+    std::list<std::string> recently_used_paths;
+    std::unordered_map<std::string, std::pair<CachedInstance, std::list<std::string>::iterator> > entries;
+
+    static std::filesystem::file_time_type latest_modification_time(const std::string& instance_folder_path) {
+        std::filesystem::file_time_type modification_time = std::filesystem::last_write_time(instance_folder_path);
+        for (const auto& entry : std::filesystem::directory_iterator(instance_folder_path)) {
+            modification_time = std::max(modification_time, entry.last_write_time());
+        }
+        return modification_time;
+    }
+
+public:
+    InstanceCache(size_t cache_capacity) : capacity(std::max<size_t>(cache_capacity, 1)) {}
+
+    const CachedInstance& get(const std::string& instance_folder_path, const AlgorithmConfig& algorithm_config) {
+        std::string folder_path = std::filesystem::weakly_canonical(instance_folder_path).string();
+        std::string key = folder_path + (algorithm_config.renumber_locations ? "|renumbered" : "")
+            + "|sparse=" + std::to_string(algorithm_config.sparse_travel_time_neighbours);
+        std::filesystem::file_time_type modification_time = latest_modification_time(folder_path);
+
+        auto it = entries.find(key);
+        if (it != entries.end() && it->second.first.modification_time == modification_time) {
+            recently_used_paths.splice(recently_used_paths.begin(), recently_used_paths, it->second.second);
+            return it->second.first;
+        }
+
+        VRPPDInstanceData instance_data = process_instance_folder(folder_path, algorithm_config.sparse_travel_time_neighbours);
+        CachedInstance instance;
+        instance.instance_name = instance_data.instance_name;
+        instance.modification_time = modification_time;
+        instance.param = std::make_shared<const VRPPDParameters>(instance_data, algorithm_config.renumber_locations);
+
+        if (it != entries.end()) {
+            recently_used_paths.splice(recently_used_paths.begin(), recently_used_paths, it->second.second);
+            it->second.first = std::move(instance);
+        } else {
+            if (entries.size() >= capacity) {
+                entries.erase(recently_used_paths.back());
+                recently_used_paths.pop_back();
+            }
+            recently_used_paths.push_front(key);
+            it = entries.emplace(key, std::make_pair(std::move(instance), recently_used_paths.begin())).first;
+        }
+        return it->second.first;
+    }
+};
+
+// Line based protocol:
+//   solve <instance_folder> [config=<file>] [key=value ...]
+//     the entries override the config file wherever it is listed, a missing config file is an error
+//     -> "OK <total_delivery_time> <iterations>", the routing plan in CSV format, "END"
+//   quit
+// Failures are answered with "ERROR <message>".
+void run_solver_server(std::istream& input_stream, std::ostream& output_stream, size_t cache_capacity) {
+    InstanceCache instance_cache(cache_capacity);
+    std::string line;
+
+    while (std::getline(input_stream, line)) {
+        std::istringstream line_stream(line);
+        std::string command, instance_folder_path, entry;
+        line_stream >> command;
+        if (command.empty()) continue;
+        if (command == "quit") break;
+
+        try {
+            if (command != "solve") {
+                throw std::runtime_error("Unknown command: " + command);
+            }
+            if (!(line_stream >> instance_folder_path)) {
+                throw std::runtime_error("Missing instance folder");
+            }
+
+            // The config file is the base of the request, the key=value entries override it in any order
+            std::vector<std::string> entries;
+            std::string config_file_path;
+            while (line_stream >> entry) {
+                if (entry.rfind("config=", 0) != 0) {
+                    entries.push_back(entry);
+                } else if (!config_file_path.empty()) {
+                    throw std::runtime_error("Duplicate config entry: " + entry);
+                } else {
+                    config_file_path = entry.substr(7);
+                    if (!std::filesystem::is_regular_file(config_file_path)) {
+                        throw std::runtime_error("Failed to open config file: " + config_file_path);
+                    }
+                }
+            }
+            AlgorithmConfig algorithm_config = config_file_path.empty() ? AlgorithmConfig() : AlgorithmConfig(config_file_path);
+            for (const std::string& config_entry : entries) {
+                if (!algorithm_config.set_entry(config_entry)) {
+                    throw std::runtime_error("Unknown config entry: " + config_entry);
+                }
+            }
+
+            const CachedInstance& instance = instance_cache.get(instance_folder_path, algorithm_config);
+            std::shared_ptr<const VRPPDParameters> param = instance.param;
+
+            SolverStatistics statistics;
+            VRPPDSolution warm_start_solution = load_warm_start_solution(*param, algorithm_config, instance.instance_name);
+            VRPPDSolution best_solution = solve_vrppd(*param, algorithm_config, warm_start_solution, statistics);
+            if (!best_solution.is_feasible_solution) {
+                throw std::runtime_error("No feasible solution found");
+            }
+
+            output_stream << "OK " << best_solution.total_delivery_time << " " << statistics.iterations << "\n";
+            write_solution(*param, best_solution, output_stream);
+            output_stream << "\nEND" << std::endl;
+        } catch (const std::exception& e) {
+            output_stream << "ERROR " << e.what() << std::endl;
+        }
+    }
+}
+
+#endif // SOLVER_SERVER_CPP
@@ -3,10 +3,12 @@
 
 #include "vrppd_parameters.h"
 #include "vrppd_solution.h"
+#include "route_cache.h"
 #include <vector>
 #include <algorithm>
 #include <numeric>
 #include <cmath>
+#include <functional>
 
 std::vector<std::vector<int>> catalan_combinations(int n) {
     std::vector<std::vector<int>> result;
@@ -47,6 +49,15 @@ std::vector<std::vector<int>> catalan_combinations(int n) {
 }
 
 
+// Bracket patterns of all pickup/dropoff sequences of up to four deliveries, computed once
+const std::vector<std::vector<int>>& cached_catalan_combinations(int n) {
+    static const std::vector<std::vector<std::vector<int>>> combinations_by_count = {
+        catalan_combinations(0), catalan_combinations(1), catalan_combinations(2), catalan_combinations(3), catalan_combinations(4)
+    };
+    return combinations_by_count[n];
+}
+
+
 double delivery_time_of_rerouting(const VRPPDParameters& param, const VRPPDSolution& sol, int courier_index, const std::vector<int>& new_route) {
     double courier_attributed_delivery_time = 0;
     double current_time = 0;
@@ -60,13 +71,13 @@ double delivery_time_of_rerouting(const VRPPDParameters& param, const VRPPDSolut
                 return std::numeric_limits<double>::max();
             }
             current_time = std::max(
-                current_time + param.location_distance_matrix[current_location][param.delivery_pickup_location[new_route[i] - 1]],
+                current_time + param.location_distance_matrix(current_location, param.delivery_pickup_location[new_route[i] - 1]),
                 param.delivery_release_time[new_route[i] - 1]
             );
             current_location = param.delivery_pickup_location[new_route[i] - 1];
         } else if (new_route[i] < 0) {
             current_load -= param.delivery_capacity[-new_route[i] - 1];
-            current_time += param.location_distance_matrix[current_location][param.delivery_dropoff_location[-new_route[i] - 1]];
+            current_time += param.location_distance_matrix(current_location, param.delivery_dropoff_location[-new_route[i] - 1]);
             if(current_time > sol.max_delivery_delivery_time){
                 courier_attributed_delivery_time = std::numeric_limits<double>::max();
             }else{
@@ -93,15 +104,15 @@ void apply_rerouting(const VRPPDParameters& param, VRPPDSolution& sol, int couri
         if (new_route[i] > 0) {
             sol.courier_current_load[courier_index - 1] += param.delivery_capacity[new_route[i] - 1];
             current_time = std::max(
-                current_time + param.location_distance_matrix[current_location][param.delivery_pickup_location[new_route[i] - 1]],
+                current_time + param.location_distance_matrix(current_location, param.delivery_pickup_location[new_route[i] - 1]),
                 param.delivery_release_time[new_route[i] - 1]
             );
             current_location = param.delivery_pickup_location[new_route[i] - 1];
             //std::cout << "Delivery " << new_route[i] << " picked up at " << current_location << " at time " << current_time << std::endl;
         } else if (new_route[i] < 0) {
             sol.courier_current_load[courier_index - 1] -= param.delivery_capacity[-new_route[i] - 1];
-            sol.delivery_delivery_time[-new_route[i] - 1] = current_time + param.location_distance_matrix[current_location][param.delivery_dropoff_location[-new_route[i] - 1]];
-            //std::cout << "delivery time " << sol.delivery_delivery_time[-new_route[i] - 1] << " = " << current_time << " + " << param.location_distance_matrix[current_location][param.delivery_dropoff_location[-new_route[i] - 1]] << std::endl;
+            sol.delivery_delivery_time[-new_route[i] - 1] = current_time + param.location_distance_matrix(current_location, param.delivery_dropoff_location[-new_route[i] - 1]);
+            //std::cout << "delivery time " << sol.delivery_delivery_time[-new_route[i] - 1] << " = " << current_time << " + " << param.location_distance_matrix(current_location, param.delivery_dropoff_location[-new_route[i] - 1]) << std::endl;
             current_time = sol.delivery_delivery_time[-new_route[i] - 1];
             current_location = param.delivery_dropoff_location[-new_route[i] - 1];
             sol.courier_attributed_delivery_time[courier_index - 1] += current_time;
@@ -114,9 +125,10 @@ void apply_rerouting(const VRPPDParameters& param, VRPPDSolution& sol, int couri
 
 }
 
-void stack_courier_deliveries(const VRPPDParameters& param, VRPPDSolution& sol, int courier_index) {
+void stack_courier_deliveries(const VRPPDParameters& param, VRPPDSolution& sol, int courier_index, RouteCache* route_cache = nullptr) {
 
     if (sol.delivery_count_assigned_to_courier[courier_index - 1] <= 1) {
+        sol.courier_route_is_stacked[courier_index - 1] = true;
         return;
     }
 
@@ -133,37 +145,59 @@ void stack_courier_deliveries(const VRPPDParameters& param, VRPPDSolution& sol,
         }
     }
     if (sol.delivery_count_assigned_to_courier[courier_index - 1] < 5) {
-        std::vector<int> permutation = deliveries_in_route;
-        do {
-            for (const auto& combination : catalan_combinations(sol.delivery_count_assigned_to_courier[courier_index - 1])) {
-                for (size_t i = 0; i < combination.size(); ++i) {
-                    if (combination[i] > 0) {
-                        incumbent_route[i] = permutation[combination[i] - 1];
-                    } else {
-                        incumbent_route[i] = -permutation[-combination[i] - 1];
+        // Starting from the sorted order, next_permutation enumerates all orders of the deliveries
+        std::sort(deliveries_in_route.begin(), deliveries_in_route.end());
+
+        RouteCacheKey route_cache_key{param.courier_starting_location[courier_index - 1], param.courier_capacity[courier_index - 1], sol.max_delivery_delivery_time, {0, 0, 0, 0}};
+        std::copy(deliveries_in_route.begin(), deliveries_in_route.end(), route_cache_key.deliveries.begin());
+        RouteCacheEntry route_cache_entry;
+        if (route_cache != nullptr && route_cache->find(route_cache_key, route_cache_entry)) {
+            if (route_cache_entry.delivery_time < best_route_total_delivery_time) {
+                std::copy(route_cache_entry.route.begin(), route_cache_entry.route.begin() + best_route.size(), best_route.begin());
+            }
+        } else {
+            std::vector<int> permutation = deliveries_in_route;
+            const std::vector<std::vector<int>>& combinations = cached_catalan_combinations(sol.delivery_count_assigned_to_courier[courier_index - 1]);
+            do {
+                for (const auto& combination : combinations) {
+                    for (size_t i = 0; i < combination.size(); ++i) {
+                        if (combination[i] > 0) {
+                            incumbent_route[i] = permutation[combination[i] - 1];
+                        } else {
+                            incumbent_route[i] = -permutation[-combination[i] - 1];
+                        }
+                    }
+                    double incumbent_route_total_delivery_time = delivery_time_of_rerouting(param, sol, courier_index, incumbent_route);
+                    if (incumbent_route_total_delivery_time <= best_route_total_delivery_time) {
+                        best_route = incumbent_route;
+                        best_route_total_delivery_time = incumbent_route_total_delivery_time;
                     }
                 }
-                double incumbent_route_total_delivery_time = delivery_time_of_rerouting(param, sol, courier_index, incumbent_route);
-                if (incumbent_route_total_delivery_time <= best_route_total_delivery_time) {
-                    best_route = incumbent_route;
-                    best_route_total_delivery_time = incumbent_route_total_delivery_time;
-                }
+            } while (std::next_permutation(permutation.begin(), permutation.end()));
+
+            if (route_cache != nullptr) {
+                route_cache_entry.route.fill(0);
+                std::copy(best_route.begin(), best_route.begin() + std::min<size_t>(best_route.size(), route_cache_entry.route.size()), route_cache_entry.route.begin());
+                route_cache_entry.delivery_time = best_route_total_delivery_time;
+                route_cache->insert(route_cache_key, route_cache_entry);
             }
-        } while (std::next_permutation(permutation.begin(), permutation.end()));
+        }
     }else{
         throw std::runtime_error("Delivery count assigned to courier is too high for rerouting");
     }
 
     // Update the solution
     apply_rerouting(param, sol, courier_index, best_route);
+    sol.courier_route_is_stacked[courier_index - 1] = true;
 }
 
 
-void stack_all_courier_deliveries(const VRPPDParameters& param, VRPPDSolution& sol) {
-    std::vector<int> former_routing_plan, new_routing_plan;
-
+// Restacks all couriers whose route changed since they were stacked last
+void stack_all_courier_deliveries(const VRPPDParameters& param, VRPPDSolution& sol, RouteCache* route_cache = nullptr) {
     for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
-        stack_courier_deliveries(param, sol, courier_index);
+        if (!sol.courier_route_is_stacked[courier_index - 1]) {
+            stack_courier_deliveries(param, sol, courier_index, route_cache);
+        }
     }
 }
 
@@ -0,0 +1,127 @@
+#ifndef TRAVEL_TIME_MATRIX_H
+#define TRAVEL_TIME_MATRIX_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <memory>
+#include <span>
+
+// Travel times between locations, either as dense row-major matrix or, for very large cities, as compressed
+// sparse rows which only keep selected entries. Entries which are not stored are out of range (infinity),
+// so every route using them exceeds the time limit. The travel times are immutable and shared between copies,
+// so sub-instances refer to the matrix of the full instance without copying it. A dense matrix can also refer to
+// travel times owned by the caller.
+class TravelTimeMatrix {
+private:
+    struct Storage {
+        // Points into owned_dense_travel_times or to the travel times of the caller
+        const double* dense_travel_times = nullptr;
+        std::vector<double> owned_dense_travel_times;
+        std::vector<size_t> row_offsets;
+        std::vector<int> column_indices;
+        std::vector<double> sparse_travel_times;
+    };
+
+    int location_count = 0;
+    bool is_sparse_matrix = false;
+    std::shared_ptr<const Storage> storage = std::make_shared<const Storage>();
+
+    // Row-major dense matrix of location_count x location_count travel times
+    TravelTimeMatrix(int count, std::vector<double> travel_times) : location_count(count) {
+        auto dense_storage = std::make_shared<Storage>();
+        dense_storage->owned_dense_travel_times = std::move(travel_times);
+        dense_storage->dense_travel_times = dense_storage->owned_dense_travel_times.data();
+        storage = dense_storage;
+    }
+
+    static std::vector<double> flattened(const std::vector<std::vector<double> >& travel_times) {
+        std::vector<double> flat_travel_times;
+        flat_travel_times.reserve(travel_times.size() * travel_times.size());
+        for (const auto& row : travel_times) flat_travel_times.insert(flat_travel_times.end(), row.begin(), row.end());
+        return flat_travel_times;
+    }
+
+public:
+    TravelTimeMatrix() {}
+
+    TravelTimeMatrix(const std::vector<std::vector<double> >& travel_times)
+        : TravelTimeMatrix(travel_times.size(), flattened(travel_times)) {}
+
+    // Dense matrix on row-major count x count travel times without copying them, they must outlive the matrix
+    // and all its copies
+    TravelTimeMatrix(int count, std::span<const double> travel_times) : location_count(count) {
+        auto dense_storage = std::make_shared<Storage>();
+        dense_storage->dense_travel_times = travel_times.data();
+        storage = dense_storage;
+    }
+
+    // Sparse matrix from the stored (column, travel time) entries of every row
+    TravelTimeMatrix(const std::vector<std::vector<std::pair<int, double> > >& row_entries)
+        : location_count(row_entries.size()), is_sparse_matrix(true) {
+        auto sparse_storage = std::make_shared<Storage>();
+        sparse_storage->row_offsets.reserve(location_count + 1);
+        sparse_storage->row_offsets.push_back(0);
+        for (auto row : row_entries) {
+            std::sort(row.begin(), row.end());
+            row.erase(std::unique(row.begin(), row.end(),
+                [](const auto& a, const auto& b) { return a.first == b.first; }), row.end());
+            for (const auto& entry : row) {
+                sparse_storage->column_indices.push_back(entry.first);
+                sparse_storage->sparse_travel_times.push_back(entry.second);
+            }
+            sparse_storage->row_offsets.push_back(sparse_storage->column_indices.size());
+        }
+        storage = sparse_storage;
+    }
+
+    int size() const { return location_count; }
+
+    bool is_sparse() const { return is_sparse_matrix; }
+
+    // Row-major travel times of a dense matrix, nullptr in sparse mode
+    const double* dense_data() const { return is_sparse_matrix ? nullptr : storage->dense_travel_times; }
+
+    double operator()(int from, int to) const {
+        if (!is_sparse_matrix) return storage->dense_travel_times[static_cast<size_t>(from) * location_count + to];
+        const std::vector<int>& column_indices = storage->column_indices;
+        auto row_begin = column_indices.begin() + storage->row_offsets[from], row_end = column_indices.begin() + storage->row_offsets[from + 1];
+        auto it = std::lower_bound(row_begin, row_end, to);
+        if (it == row_end || *it != to) return std::numeric_limits<double>::infinity();
+        return storage->sparse_travel_times[it - column_indices.begin()];
+    }
+
+    // Locations with a stored travel time from the given location
+    std::vector<int> neighbours(int from) const {
+        if (!is_sparse_matrix) {
+            std::vector<int> all_locations(location_count);
+            for (int j = 0; j < location_count; ++j) all_locations[j] = j;
+            return all_locations;
+        }
+        return std::vector<int>(storage->column_indices.begin() + storage->row_offsets[from], storage->column_indices.begin() + storage->row_offsets[from + 1]);
+    }
+
+    // Matrix in which location order[i] becomes location i
+    TravelTimeMatrix renumbered(const std::vector<int>& order) const {
+        if (!is_sparse_matrix) {
+            std::vector<double> travel_times(static_cast<size_t>(location_count) * location_count);
+            for (int i = 0; i < location_count; ++i) {
+                for (int j = 0; j < location_count; ++j) {
+                    travel_times[static_cast<size_t>(i) * location_count + j] = (*this)(order[i], order[j]);
+                }
+            }
+            return TravelTimeMatrix(location_count, std::move(travel_times));
+        }
+        std::vector<int> new_index(location_count);
+        for (int i = 0; i < location_count; ++i) new_index[order[i]] = i;
+        std::vector<std::vector<std::pair<int, double> > > row_entries(location_count);
+        for (int i = 0; i < location_count; ++i) {
+            for (size_t k = storage->row_offsets[order[i]]; k < storage->row_offsets[order[i] + 1]; ++k) {
+                row_entries[i].emplace_back(new_index[storage->column_indices[k]], storage->sparse_travel_times[k]);
+            }
+        }
+        return TravelTimeMatrix(row_entries);
+    }
+};
+
+#endif // TRAVEL_TIME_MATRIX_H
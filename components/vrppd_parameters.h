@@ -3,7 +3,11 @@
 
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <map>
+#include <cstdint>
 #include "read_data.cpp"
+#include "travel_time_matrix.h"
 
 struct VRPPDParameters {
     int delivery_count;
@@ -11,30 +15,54 @@ struct VRPPDParameters {
     std::vector<double> delivery_release_time;
     std::vector<int> delivery_pickup_location;
     std::vector<int> delivery_dropoff_location;
+    std::vector<int> delivery_pickup_stacking_id;
+    // Deliveries sharing pickup stacking id and pickup location form a stacking group
+    std::vector<int> delivery_stacking_group;
+    std::vector<std::vector<int> > stacking_group_deliveries;
+    // Travel time from the pickup to the dropoff location of each delivery
+    std::vector<double> delivery_direct_travel_time;
 
     int courier_count;
     std::vector<int> courier_capacity;
     std::vector<int> courier_starting_location;
+    // Couriers of equal capacity share a capacity class
+    std::vector<int> courier_capacity_class;
+    std::vector<int> capacity_class_capacity;
+    // Couriers with equal starting location and capacity are interchangeable and share a symmetry class,
+    // the couriers of a class are sorted by index
+    std::vector<int> courier_symmetry_class;
+    std::vector<std::vector<int> > symmetry_class_couriers;
 
     int location_count;
-    std::vector<std::vector<double> > location_distance_matrix;
+    TravelTimeMatrix location_distance_matrix;
     std::vector<std::vector<int> > location_nearest_location_matrix;
     std::vector<std::vector<int> > location_nearest_delivery_matrix;
+    // Bitsets over the ranks of location_nearest_delivery_matrix, stored flat: the words of a location start
+    // at location_delivery_bits_offset[location]. Bit i is set in location_delivery_bits if the location has an
+    // i-th nearest delivery, and in location_delivery_capacity_mask[class] if that delivery fits into the
+    // couriers of the capacity class
+    std::vector<size_t> location_delivery_bits_offset;
+    std::vector<uint64_t> location_delivery_bits;
+    std::vector<std::vector<uint64_t> > location_delivery_capacity_mask;
 
-    VRPPDParameters(const VRPPDInstanceData& instance) {
+    VRPPDParameters(const VRPPDInstanceData& instance, bool renumber_locations = false) {
         delivery_count = instance.deliveries.size();
         delivery_capacity.reserve(delivery_count);
         delivery_release_time.reserve(delivery_count);
         delivery_pickup_location.reserve(delivery_count);
         delivery_dropoff_location.reserve(delivery_count);
+        delivery_pickup_stacking_id.reserve(delivery_count);
 
         for (const auto& delivery : instance.deliveries) {
             delivery_capacity.push_back(delivery.capacity);
             delivery_release_time.push_back(delivery.time_window_start);
             delivery_pickup_location.push_back(delivery.pickup_loc - 1);
             delivery_dropoff_location.push_back(delivery.dropoff_loc - 1);
+            delivery_pickup_stacking_id.push_back(delivery.pickup_stacking_id);
         }
 
+        initialize_stacking_groups();
+
         courier_count = instance.couriers.size();
         courier_capacity.reserve(courier_count);
         courier_starting_location.reserve(courier_count);
@@ -43,27 +71,43 @@ struct VRPPDParameters {
             courier_capacity.push_back(courier.capacity);
             courier_starting_location.push_back(courier.location - 1);
         }
+        initialize_courier_classes();
+
+        location_distance_matrix = instance.travel_time.empty() ? instance.travel_time_matrix : TravelTimeMatrix(instance.travel_time);
+        location_count = location_distance_matrix.size();
+        if (renumber_locations) apply_location_renumbering(nearest_neighbour_location_order());
 
-        location_count = instance.travel_time.size();
-        location_distance_matrix = instance.travel_time;
+        delivery_direct_travel_time.reserve(delivery_count);
+        for (int i = 0; i < delivery_count; ++i) {
+            delivery_direct_travel_time.push_back(location_distance_matrix(delivery_pickup_location[i], delivery_dropoff_location[i]));
+        }
 
-        // Initialize location_nearest_location_matrix
+        // Initialize location_nearest_location_matrix, in sparse mode only stored travel times are considered
         location_nearest_location_matrix.resize(location_count);
         for (int i = 0; i < location_count; ++i) {
-            std::vector<int> indices(location_count);
-            for (int j = 0; j < location_count; ++j) indices[j] = j;
+            std::vector<int> indices = location_distance_matrix.neighbours(i);
             std::sort(indices.begin(), indices.end(),
-                [&](int a, int b) { return location_distance_matrix[i][a] < location_distance_matrix[i][b]; });
+                [&](int a, int b) { return location_distance_matrix(i, a) < location_distance_matrix(i, b); });
             indices.erase(std::remove(indices.begin(), indices.end(), i), indices.end());
             location_nearest_location_matrix[i] = indices;
         }
 
-        // Initialize location_nearest_delivery_matrix
+        // Initialize location_nearest_delivery_matrix, in sparse mode only with the pickups in range
+        std::vector<std::vector<int> > location_pickup_deliveries(location_count);
+        for (int j = 0; j < delivery_count; ++j) location_pickup_deliveries[delivery_pickup_location[j]].push_back(j);
         location_nearest_delivery_matrix.resize(location_count);
         for (int i = 0; i < location_count; ++i) {
             std::vector<std::pair<int, double>> delivery_distances;
-            for (int j = 0; j < delivery_count; ++j) {
-                delivery_distances.emplace_back(j, location_distance_matrix[i][delivery_pickup_location[j]]);
+            if (location_distance_matrix.is_sparse()) {
+                for (int pickup_location : location_distance_matrix.neighbours(i)) {
+                    for (int j : location_pickup_deliveries[pickup_location]) {
+                        delivery_distances.emplace_back(j, location_distance_matrix(i, pickup_location));
+                    }
+                }
+            } else {
+                for (int j = 0; j < delivery_count; ++j) {
+                    delivery_distances.emplace_back(j, location_distance_matrix(i, delivery_pickup_location[j]));
+                }
             }
             std::sort(delivery_distances.begin(), delivery_distances.end(),
                 [](const auto& a, const auto& b) { return a.second < b.second; });
@@ -71,6 +115,149 @@ struct VRPPDParameters {
                 location_nearest_delivery_matrix[i].push_back(pair.first + 1);
             }
         }
+
+
+        initialize_delivery_bits();
+    }
+
+    // Sub-instance of the given couriers and deliveries of a full instance, which are renumbered from 1 in the
+    // given order. The travel time matrix is shared with the full instance. Its couriers can only be at their
+    // starting locations or at dropoff locations of its deliveries, so the nearest delivery lists are only built
+    // for these locations and location_nearest_location_matrix stays empty.
+    VRPPDParameters(const VRPPDParameters& full, const std::vector<int>& courier_indices, const std::vector<int>& delivery_indices)
+        : delivery_count(delivery_indices.size()), courier_count(courier_indices.size()), location_count(full.location_count),
+          location_distance_matrix(full.location_distance_matrix) {
+        std::vector<int> local_delivery_index(full.delivery_count, 0);
+        for (int i = 0; i < delivery_count; ++i) {
+            int delivery_index = delivery_indices[i];
+            local_delivery_index[delivery_index - 1] = i + 1;
+            delivery_capacity.push_back(full.delivery_capacity[delivery_index - 1]);
+            delivery_release_time.push_back(full.delivery_release_time[delivery_index - 1]);
+            delivery_pickup_location.push_back(full.delivery_pickup_location[delivery_index - 1]);
+            delivery_dropoff_location.push_back(full.delivery_dropoff_location[delivery_index - 1]);
+            delivery_pickup_stacking_id.push_back(full.delivery_pickup_stacking_id[delivery_index - 1]);
+            delivery_direct_travel_time.push_back(full.delivery_direct_travel_time[delivery_index - 1]);
+        }
+        initialize_stacking_groups();
+
+        for (int courier_index : courier_indices) {
+            courier_capacity.push_back(full.courier_capacity[courier_index - 1]);
+            courier_starting_location.push_back(full.courier_starting_location[courier_index - 1]);
+        }
+        initialize_courier_classes();
+
+        // The lists of the full instance are already sorted by distance
+        location_nearest_delivery_matrix.resize(location_count);
+        std::vector<bool> is_location_listed(location_count, false);
+        auto list_location = [&](int location) {
+            if (is_location_listed[location]) return;
+            is_location_listed[location] = true;
+            for (int delivery_index : full.location_nearest_delivery_matrix[location]) {
+                if (local_delivery_index[delivery_index - 1] > 0) location_nearest_delivery_matrix[location].push_back(local_delivery_index[delivery_index - 1]);
+            }
+        };
+        for (int location : courier_starting_location) list_location(location);
+        for (int location : delivery_dropoff_location) list_location(location);
+
+        initialize_delivery_bits();
+    }
+
+    // Deliveries sharing pickup stacking id and pickup location, sorted by release time
+    void initialize_stacking_groups() {
+        std::map<std::pair<int, int>, int> stacking_group_index;
+        delivery_stacking_group.resize(delivery_count);
+        for (int i = 0; i < delivery_count; ++i) {
+            auto inserted = stacking_group_index.emplace(std::make_pair(delivery_pickup_stacking_id[i], delivery_pickup_location[i]), stacking_group_deliveries.size());
+            if (inserted.second) stacking_group_deliveries.emplace_back();
+            delivery_stacking_group[i] = inserted.first->second;
+            stacking_group_deliveries[inserted.first->second].push_back(i + 1);
+        }
+        for (auto& group : stacking_group_deliveries) {
+            std::stable_sort(group.begin(), group.end(),
+                [&](int a, int b) { return delivery_release_time[a - 1] < delivery_release_time[b - 1]; });
+        }
+
+    }
+
+    // Capacity classes and symmetry classes of the couriers
+    void initialize_courier_classes() {
+        capacity_class_capacity = courier_capacity;
+        std::sort(capacity_class_capacity.begin(), capacity_class_capacity.end());
+        capacity_class_capacity.erase(std::unique(capacity_class_capacity.begin(), capacity_class_capacity.end()), capacity_class_capacity.end());
+        for (int capacity : courier_capacity) {
+            courier_capacity_class.push_back(std::lower_bound(capacity_class_capacity.begin(), capacity_class_capacity.end(), capacity) - capacity_class_capacity.begin());
+        }
+        std::map<std::pair<int, int>, int> symmetry_class_index;
+        for (int i = 0; i < courier_count; ++i) {
+            auto inserted = symmetry_class_index.emplace(std::make_pair(courier_starting_location[i], courier_capacity[i]), symmetry_class_couriers.size());
+            if (inserted.second) symmetry_class_couriers.emplace_back();
+            courier_symmetry_class.push_back(inserted.first->second);
+            symmetry_class_couriers[inserted.first->second].push_back(i + 1);
+        }
+
+    }
+
+    // Bitsets over the nearest delivery lists of all locations
+    void initialize_delivery_bits() {
+        location_delivery_bits_offset.assign(1, 0);
+        for (int i = 0; i < location_count; ++i) {
+            size_t candidate_count = location_nearest_delivery_matrix[i].size();
+            location_delivery_bits_offset.push_back(location_delivery_bits_offset.back() + (candidate_count + 63) / 64);
+        }
+        location_delivery_bits.assign(location_delivery_bits_offset.back(), 0);
+        location_delivery_capacity_mask.assign(capacity_class_capacity.size(), std::vector<uint64_t>(location_delivery_bits_offset.back(), 0));
+        for (int i = 0; i < location_count; ++i) {
+            const std::vector<int>& nearest_deliveries = location_nearest_delivery_matrix[i];
+            for (size_t rank = 0; rank < nearest_deliveries.size(); ++rank) {
+                size_t word = location_delivery_bits_offset[i] + rank / 64;
+                uint64_t bit = uint64_t(1) << (rank % 64);
+                location_delivery_bits[word] |= bit;
+                for (size_t capacity_class = 0; capacity_class < capacity_class_capacity.size(); ++capacity_class) {
+                    if (delivery_capacity[nearest_deliveries[rank] - 1] <= capacity_class_capacity[capacity_class]) {
+                        location_delivery_capacity_mask[capacity_class][word] |= bit;
+                    }
+                }
+            }
+        }
+    }
+
+    // Orders the locations as a nearest neighbour chain through the travel time matrix,
+    // such that mutually close locations get neighbouring indices
+    std::vector<int> nearest_neighbour_location_order() const {
+        std::vector<int> order;
+        order.reserve(location_count);
+        std::vector<bool> is_ordered(location_count, false);
+        int first_unordered_location = 0;
+        int current_location = location_count > 0 ? 0 : -1;
+        while (current_location >= 0) {
+            order.push_back(current_location);
+            is_ordered[current_location] = true;
+            int next_location = -1;
+            for (int j : location_distance_matrix.neighbours(current_location)) {
+                if (!is_ordered[j] && (next_location < 0 || location_distance_matrix(current_location, j) < location_distance_matrix(current_location, next_location))) {
+                    next_location = j;
+                }
+            }
+            // In sparse mode all stored neighbours may be ordered already
+            while (next_location < 0 && first_unordered_location < location_count) {
+                if (!is_ordered[first_unordered_location]) next_location = first_unordered_location;
+                first_unordered_location++;
+            }
+            current_location = next_location;
+        }
+        return order;
+    }
+
+    // Renumbers all locations such that location order[i] becomes location i
+    void apply_location_renumbering(const std::vector<int>& order) {
+        std::vector<int> new_index(location_count);
+        for (int i = 0; i < location_count; ++i) new_index[order[i]] = i;
+
+        location_distance_matrix = location_distance_matrix.renumbered(order);
+
+        for (auto& location : delivery_pickup_location) location = new_index[location];
+        for (auto& location : delivery_dropoff_location) location = new_index[location];
+        for (auto& location : courier_starting_location) location = new_index[location];
     }
 };
 
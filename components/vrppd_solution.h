@@ -2,6 +2,7 @@
 #define VRPPD_SOLUTION_H
 
 #include <vector>
+#include <limits>
 
 
 struct VRPPDSolution {
@@ -15,15 +16,22 @@ struct VRPPDSolution {
     std::vector<int> delivery_assigned_courier;
     std::vector<double> courier_attributed_delivery_time;
     std::vector<double> courier_current_load;
+    std::vector<bool> courier_route_is_stacked;
+    // Couriers outside the courier subset of a scenario are not available
+    std::vector<bool> courier_is_available;
 
-    VRPPDSolution(int courier_count, int delivery_count)
-        : total_delivery_time(std::numeric_limits<double>::max()),
+    VRPPDSolution(int courier_count, int delivery_count, int max_deliveries = 4, int max_delivery_time = 180)
+        : max_num_of_deliveries_assignable_to_courier(max_deliveries),
+          max_delivery_delivery_time(max_delivery_time),
+          total_delivery_time(std::numeric_limits<double>::max()),
           routing_plan(courier_count, std::vector<int>(2*max_num_of_deliveries_assignable_to_courier, 0)),
           delivery_count_assigned_to_courier(courier_count, 0),
           delivery_delivery_time(delivery_count, std::numeric_limits<double>::max()),
           delivery_assigned_courier(delivery_count, 0),
           courier_attributed_delivery_time(courier_count, 0),
-          courier_current_load(courier_count, 0.0) {}
+          courier_current_load(courier_count, 0.0),
+          courier_route_is_stacked(courier_count, false),
+          courier_is_available(courier_count, true) {}
 };
 
 #endif // VRPPD_SOLUTION_H
@@ -0,0 +1,78 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// Fixed set of threads which run one batch of tasks at a time, so parallel sections repeated in every restart
+// do not create and join threads each time. The calling thread works on the batch as well.
+class WorkerPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_available, work_done;
+    const std::function<void(size_t)>* task = nullptr;
+    size_t task_count = 0;
+    std::atomic<size_t> next_task{0};
+    size_t finished_workers = 0;
+    size_t generation = 0;
+    bool is_stopping = false;
+
+    void work_on_tasks() {
+        for (size_t i = next_task++; i < task_count; i = next_task++) (*task)(i);
+    }
+
+    void worker_loop() {
+        size_t seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                work_available.wait(lock, [&]() { return is_stopping || generation != seen_generation; });
+                if (is_stopping) return;
+                seen_generation = generation;
+            }
+            work_on_tasks();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++finished_workers == workers.size()) work_done.notify_one();
+        }
+    }
+
+public:
+    WorkerPool(size_t thread_count) {
+        for (size_t i = 1; i < thread_count; ++i) workers.emplace_back(&WorkerPool::worker_loop, this);
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_stopping = true;
+        }
+        work_available.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs batch_task(0), ..., batch_task(batch_size - 1) and returns when all of them are done
+    void run(size_t batch_size, const std::function<void(size_t)>& batch_task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &batch_task;
+            task_count = batch_size;
+            next_task = 0;
+            finished_workers = 0;
+            generation++;
+        }
+        work_available.notify_all();
+        work_on_tasks();
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&]() { return finished_workers == workers.size(); });
+    }
+};
+
+#endif // WORKER_POOL_H
@@ -0,0 +1,68 @@
+#include <stdexcept>
+#include <cmath>
+#include "libvrppd.h"
+#include "components/vrppd_parameters.h"
+#include "components/vrppd_solution.h"
+#include "components/algorithm_config.h"
+#include "components/read_data.cpp"
+#include "components/solver.cpp"
+
+VRPPDResult vrppd_solve(const VRPPDProblem& problem, const std::vector<std::string>& config_entries,
+                        std::chrono::steady_clock::time_point deadline) {
+    AlgorithmConfig algorithm_config;
+    for (const auto& entry : config_entries) {
+        if (!algorithm_config.set_entry(entry)) {
+            throw std::invalid_argument("Unknown config entry: " + entry);
+        }
+    }
+    algorithm_config.warm_start_solution.clear();
+    // The sparse mode only pays off if the dense matrix does not fit into memory, which the caller already holds
+    if (algorithm_config.sparse_travel_time_neighbours > 0) {
+        throw std::invalid_argument("sparse_travel_time_neighbours is not supported for in-memory travel times");
+    }
+
+    // The internal instance data uses the 1-based IDs and locations of the instance files
+    size_t location_count = static_cast<size_t>(std::sqrt(static_cast<double>(problem.travel_times.size())));
+    if (location_count * location_count != problem.travel_times.size()) {
+        throw std::invalid_argument("Travel times are not a square matrix");
+    }
+    if (problem.couriers.empty() || problem.deliveries.empty()) {
+        throw std::invalid_argument("No couriers or no deliveries");
+    }
+    auto check_location = [location_count](int location) {
+        if (location < 0 || static_cast<size_t>(location) >= location_count) {
+            throw std::invalid_argument("Location " + std::to_string(location) + " is not in the travel time matrix");
+        }
+        return location + 1;
+    };
+
+    VRPPDInstanceData instance_data;
+    int courier_id = 1;
+    for (const auto& courier : problem.couriers) {
+        instance_data.couriers.emplace_back(courier_id++, check_location(courier.location), courier.capacity);
+    }
+    int delivery_id = courier_id;
+    for (const auto& delivery : problem.deliveries) {
+        instance_data.deliveries.emplace_back(delivery_id++, delivery.capacity, check_location(delivery.pickup_location),
+            delivery.release_time, delivery.pickup_stacking_id, check_location(delivery.dropoff_location));
+    }
+    instance_data.travel_time_matrix = TravelTimeMatrix(location_count, problem.travel_times);
+
+    VRPPDParameters param(instance_data, algorithm_config.renumber_locations);
+    SolverStatistics statistics;
+    VRPPDSolution best_solution = solve_vrppd(param, algorithm_config, VRPPDSolution(param.courier_count, param.delivery_count), statistics, deadline);
+
+    VRPPDResult result;
+    result.is_feasible = best_solution.is_feasible_solution;
+    result.total_delivery_time = best_solution.total_delivery_time;
+    result.routes.resize(param.courier_count);
+    for (int courier_index = 1; courier_index <= param.courier_count; ++courier_index) {
+        for (int stop : best_solution.routing_plan[courier_index - 1]) {
+            if (stop != 0) result.routes[courier_index - 1].push_back(stop);
+        }
+    }
+    result.iterations = statistics.iterations;
+    result.constructor_delivery_time = statistics.constructor_delivery_time;
+    result.elapsed_seconds = statistics.elapsed_seconds;
+    return result;
+}
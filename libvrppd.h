@@ -0,0 +1,48 @@
+#ifndef LIBVRPPD_H
+#define LIBVRPPD_H
+
+#include <span>
+#include <string>
+#include <vector>
+#include <chrono>
+
+// In-memory interface of the solver. Locations are 0-based indices into the travel time matrix, deliveries
+// and couriers are referred to by their position in the input vectors.
+
+struct VRPPDCourierInput {
+    int location;
+    int capacity;
+};
+
+struct VRPPDDeliveryInput {
+    int capacity;
+    int pickup_location;
+    int release_time;
+    int pickup_stacking_id;
+    int dropoff_location;
+};
+
+struct VRPPDProblem {
+    std::vector<VRPPDCourierInput> couriers;
+    std::vector<VRPPDDeliveryInput> deliveries;
+    // Row-major location_count x location_count travel times, the span must outlive the solve call
+    std::span<const double> travel_times;
+};
+
+struct VRPPDResult {
+    bool is_feasible = false;
+    double total_delivery_time = 0;
+    // Stops of every courier: +(d+1) picks up and -(d+1) drops off the delivery at position d
+    std::vector<std::vector<int> > routes;
+    int iterations = 0;
+    double constructor_delivery_time = 0;
+    double elapsed_seconds = 0;
+};
+
+// Solves the problem until the deadline. config_entries are "key=value" entries as in the config files,
+// entries which refer to files (warm_start_solution) are ignored. The travel times are used in place without
+// copying them. Throws std::invalid_argument for malformed input and for sparse_travel_time_neighbours. Calls do not share any state and may run concurrently.
+VRPPDResult vrppd_solve(const VRPPDProblem& problem, const std::vector<std::string>& config_entries,
+                        std::chrono::steady_clock::time_point deadline);
+
+#endif // LIBVRPPD_H
@@ -12,46 +12,59 @@
 #include "components/is_feasible.cpp"
 #include "components/read_data.cpp"
 #include "components/write_solution.cpp"
+#include "components/read_solution.cpp"
 #include "components/algorithm_config.h"
 #include "components/solution_logger.h"
+#include "components/solver.cpp"
+#include "components/solver_server.cpp"
+#include "components/scenarios.cpp"
 
 
 
 int main(int argc, char *argv[]) {
+    if (argc >= 2 && std::string(argv[1]) == "--serve") {
+        // Requests and routing plans are exchanged on stdin/stdout, solver diagnostics go to stderr
+        size_t cache_capacity = argc >= 3 ? std::stoul(argv[2]) : 8;
+        std::ostream protocol_output(std::cout.rdbuf());
+        std::cout.rdbuf(std::cerr.rdbuf());
+        run_solver_server(std::cin, protocol_output, cache_capacity);
+        return 0;
+    }
+    if (argc >= 2 && std::string(argv[1]) == "--scenarios") {
+        if (argc < 6) {
+            throw std::runtime_error("Usage: solver --scenarios <instance_folder> <config_file> <scenario_file> <output_folder>");
+        }
+        AlgorithmConfig base_config(argv[3]);
+        std::vector<VRPPDScenario> scenarios = read_scenarios(argv[4], base_config);
+        VRPPDInstanceData instance_data = process_instance_folder(argv[2], base_config.sparse_travel_time_neighbours);
+        VRPPDParameters param(instance_data, base_config.renumber_locations);
+        solve_scenarios(param, instance_data.instance_name, scenarios, argv[5]);
+        return 0;
+    }
+
     std::string path_to_problem_parameters   = argv[1],
                 path_to_solver_parameters    = argv[2],
                 path_for_solution_file       = argv[3];
 
-    VRPPDInstanceData instance_data = process_instance_folder(path_to_problem_parameters);
-    VRPPDParameters param(instance_data);
-
     AlgorithmConfig algorithm_config(path_to_solver_parameters);
 
-    VRPPDSolution best_solution(param.courier_count, param.delivery_count),
-                  incumbent_solution(param.courier_count, param.delivery_count);
+    VRPPDInstanceData instance_data = process_instance_folder(path_to_problem_parameters, algorithm_config.sparse_travel_time_neighbours);
+    VRPPDParameters param(instance_data, algorithm_config.renumber_locations);
 
-    if (best_solution.max_num_of_deliveries_assignable_to_courier < param.delivery_count / param.courier_count) {
-        throw std::runtime_error("The number of couriers per delivery is too low");
-    }
+    VRPPDSolution warm_start_solution = load_warm_start_solution(param, algorithm_config, instance_data.instance_name);
 
-    auto time_start = std::chrono::high_resolution_clock::now();
-    int iteration = 0;
-    // std::cout << "Starting iterations" << std::endl;
-    while(true){
-        if (std::chrono::duration_cast<std::chrono::seconds>(std::chrono::high_resolution_clock::now() - time_start).count() >= algorithm_config.time_limit) break;
-        //if(iteration >= 1000) break;
-        //std::cout << "Iteration " << iteration << ": start ";
-        iteration++;
-        incumbent_solution = VRPPDSolution(param.courier_count, param.delivery_count);
-        random_greedy_courier_heuristic(param, incumbent_solution);
-        if(incumbent_solution.is_feasible_solution) stack_all_courier_deliveries(param, incumbent_solution);
-        //std::cout << " -> 3" << std::endl;
-        if (incumbent_solution.total_delivery_time < best_solution.total_delivery_time) {
-            best_solution = incumbent_solution;
-        }
-        //std::cout << "Iteration " << iteration << " done" << std::endl;
+    SolverStatistics statistics;
+    VRPPDSolution best_solution = solve_vrppd(param, algorithm_config, warm_start_solution, statistics);
+    if (statistics.warm_start_delivery_time < std::numeric_limits<double>::max()) {
+        std::cout << "Warm start solution: " << statistics.warm_start_delivery_time << std::endl;
+    }
+    if (statistics.constructor_delivery_time < std::numeric_limits<double>::max()) {
+        std::cout << "Constructor solution: " << statistics.constructor_delivery_time << std::endl;
+    }
+    std::cout << "Iterations: " << statistics.iterations << " done" << std::endl;
+    if (statistics.duplicate_restarts > 0) {
+        std::cout << "Duplicate restarts: " << statistics.duplicate_restarts << std::endl;
     }
-    std::cout << "Iterations: " << iteration << " done" << std::endl;
 
 
     if (!is_feasible(param, best_solution) || !best_solution.is_feasible_solution) { 
@@ -65,4 +78,4 @@ int main(int argc, char *argv[]) {
     //if(algorithm_config.log_output) solution_logger.write();
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+// Compares sparse_min_cost_assignment with a brute force search on random small instances.
+// Built and run via: "g++ -std=c++20 -O2 tests/check_assignment.cpp -o bin/check_assignment && bin/check_assignment"
+#include <iostream>
+#include <random>
+#include <vector>
+#include <cmath>
+#include "../components/assignment_heuristic.cpp"
+
+// Maximum cardinality and the minimum cost among the assignments of that cardinality
+void brute_force_assignment(const std::vector<std::vector<AssignmentEdge> >& row_edges, size_t row, std::vector<bool>& is_column_used,
+                            int cardinality, double cost, int& best_cardinality, double& best_cost) {
+    if (row == row_edges.size()) {
+        if (cardinality > best_cardinality || (cardinality == best_cardinality && cost < best_cost)) {
+            best_cardinality = cardinality;
+            best_cost = cost;
+        }
+        return;
+    }
+    brute_force_assignment(row_edges, row + 1, is_column_used, cardinality, cost, best_cardinality, best_cost);
+    for (const auto& edge : row_edges[row]) {
+        if (is_column_used[edge.column]) continue;
+        is_column_used[edge.column] = true;
+        brute_force_assignment(row_edges, row + 1, is_column_used, cardinality + 1, cost + edge.cost, best_cardinality, best_cost);
+        is_column_used[edge.column] = false;
+    }
+}
+
+int main() {
+    std::mt19937 gen(12345);
+    int mismatch_count = 0;
+    const int instance_count = 3000;
+    for (int instance = 0; instance < instance_count; ++instance) {
+        int row_count = std::uniform_int_distribution<>(1, 6)(gen);
+        int column_count = std::uniform_int_distribution<>(1, 6)(gen);
+        std::vector<std::vector<AssignmentEdge> > row_edges(row_count);
+        for (auto& edges : row_edges) {
+            for (int column = 0; column < column_count; ++column) {
+                if (std::uniform_real_distribution<>(0, 1)(gen) < 0.5) edges.push_back({column, double(std::uniform_int_distribution<>(1, 20)(gen))});
+            }
+        }
+
+        std::vector<int> row_match = sparse_min_cost_assignment(row_edges, column_count);
+        int cardinality = 0;
+        double cost = 0;
+        std::vector<bool> is_column_used(column_count, false);
+        bool is_valid = true;
+        for (int row = 0; row < row_count; ++row) {
+            if (row_match[row] < 0) continue;
+            auto edge = std::find_if(row_edges[row].begin(), row_edges[row].end(), [&](const AssignmentEdge& e) { return e.column == row_match[row]; });
+            if (edge == row_edges[row].end() || is_column_used[row_match[row]]) is_valid = false;
+            else cost += edge->cost;
+            is_column_used[row_match[row]] = true;
+            cardinality++;
+        }
+
+        int best_cardinality = -1;
+        double best_cost = 0;
+        std::vector<bool> is_brute_force_column_used(column_count, false);
+        brute_force_assignment(row_edges, 0, is_brute_force_column_used, 0, 0, best_cardinality, best_cost);
+        if (!is_valid || cardinality != best_cardinality || std::abs(cost - best_cost) > 1e-6) {
+            mismatch_count++;
+            std::cout << "Instance " << instance << ": cardinality " << cardinality << " cost " << cost
+                      << ", brute force cardinality " << best_cardinality << " cost " << best_cost << (is_valid ? "" : ", invalid assignment") << std::endl;
+        }
+    }
+    std::cout << mismatch_count << " of " << instance_count << " assignments differ from the brute force search" << std::endl;
+    return mismatch_count == 0 ? 0 : 1;
+}